@@ -1,16 +1,62 @@
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <cxxabi.h>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <filesystem>
+#include <fnmatch.h>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <iterator>
+#include <latch>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
 #include <ostream>
 #include <print>
+#include <random>
+#include <ranges>
+#include <semaphore>
 #include <set>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <thread>
+#include <tuple>
 #include <type_traits>
+#include <typeinfo>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
 using namespace std::string_literals; // enables s-suffix for std::string literals
 
 // #pragma GCC diagnostic ignored "-Wunused"
@@ -37,6 +83,10 @@ demangle(const char *mangled_name)
     return result;
 }
 
+// Size of a cache line on current x86-64 and most ARM cores. Used to keep independently written data apart.
+// (std::hardware_destructive_interference_size varies with compiler flags, so it's not used here.)
+constexpr std::size_t cache_line_size = 64;
+
 // -----------------+----------------+-------------------------------+-----------------------------------
 // Kind of Template | Type deduction | Full specialization allowed ? | Partial specialization allowed ? |
 // -----------------+----------------+-------------------------------+-----------------------------------
@@ -112,1076 +162,6815 @@ namespace good_tag_dispatch
 {
     // tree
 
+    // B+tree with subtree counts: nodes span a few cache lines, elements live in linked leaves, and every inner
+    // node knows how many elements are below each child, so the k-th element is found in O(log n).
+    template <typename Element>
+    class tree;
+
     template <typename Element>
     struct tree_iterator
     {
-        tree_iterator &operator++();
         using supports_plus = std::false_type;
+        using supports_jump = std::true_type; // jump(n) in O(log n)
+
+        tree_iterator &
+        operator++()
+        {
+            if (++index == leaf->count)
+            {
+                leaf  = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        Element const &
+        operator*() const
+        {
+            return leaf->keys[index];
+        }
+
+        tree_iterator
+        jump(std::size_t n) const
+        {
+            if (leaf && index + n < leaf->count) // still in the same leaf
+            {
+                return {owner, leaf, static_cast<std::uint16_t>(index + n)};
+            }
+            return owner->nth(owner->rank(*this) + n);
+        }
+
+        friend bool
+        operator==(tree_iterator const &a, tree_iterator const &b)
+        {
+            return a.leaf == b.leaf && a.index == b.index;
+        }
+
+        tree<Element> const                    *owner = nullptr;
+        typename tree<Element>::leaf_node const *leaf  = nullptr; // nullptr = end
+        std::uint16_t                            index = 0;
     };
 
     template <typename Element>
-    struct tree
+    class tree
     {
+      public:
         using iterator = tree_iterator<Element>;
-    };
 
-    // vector
+        tree() = default;
 
-    template <typename Element>
-    struct vector_iterator
-    {
-        vector_iterator &operator++();
-        vector_iterator  operator+();
-        using supports_plus = std::true_type;
-    };
+        tree(tree const &)            = delete;
+        tree &operator=(tree const &) = delete;
 
-    template <typename Element>
-    struct vector
-    {
-        using iterator = vector_iterator<Element>;
-    };
+        ~tree()
+        {
+            destroy(root);
+        }
 
-    // advance algo
+        // false if the element is already there
+        bool
+        insert(Element const &x)
+        {
+            if (not root)
+            {
+                root = new leaf_node;
+            }
 
-    template <typename Iter>
-    Iter
-    advance_impl(Iter begin, int n, std::false_type)
-    {
-        for (int i = 0; i < n; i++)
+            std::array<std::pair<inner_node *, std::uint16_t>, 32> path; // inner nodes and child taken
+            std::size_t                                            depth = 0;
+
+            node *n = root;
+            while (not n->is_leaf)
+            {
+                auto *in      = static_cast<inner_node *>(n);
+                auto  child   = child_index(in, x);
+                path[depth++] = {in, child};
+                n             = in->children[child];
+            }
+
+            auto *l   = static_cast<leaf_node *>(n);
+            auto *pos = std::lower_bound(l->keys.data(), l->keys.data() + l->count, x);
+            if (pos != l->keys.data() + l->count && not(x < *pos))
+            {
+                return false;
+            }
+            if (l->count == leaf_capacity)
+            {
+                split(l);
+                return insert(x); // descend again into the half that takes x
+            }
+
+            std::move_backward(pos, l->keys.data() + l->count, l->keys.data() + l->count + 1);
+            *pos = x;
+            ++l->count;
+            for (std::size_t d = 0; d < depth; ++d)
+            {
+                ++path[d].first->sizes[path[d].second];
+            }
+            ++elements;
+            return true;
+        }
+
+        bool
+        contains(Element const &x) const
         {
-            ++begin;
+            node const *n = root;
+            while (n && not n->is_leaf)
+            {
+                auto const *in = static_cast<inner_node const *>(n);
+                n              = in->children[child_index(in, x)];
+            }
+            if (not n)
+            {
+                return false;
+            }
+            auto const *l   = static_cast<leaf_node const *>(n);
+            auto const *pos = std::lower_bound(l->keys.data(), l->keys.data() + l->count, x);
+            return pos != l->keys.data() + l->count && not(x < *pos);
         }
-        return begin;
-    }
 
-    template <typename Iter>
-    Iter
-    advance_impl(Iter begin, int n, std::true_type)
-    {
-        return begin + n;
-    }
+        // iterator to the k-th smallest element (end() if k >= size())
+        iterator
+        nth(std::size_t k) const
+        {
+            if (k >= elements)
+            {
+                return end();
+            }
+            node const *n = root;
+            while (not n->is_leaf)
+            {
+                auto const   *in = static_cast<inner_node const *>(n);
+                std::uint16_t c  = 0;
+                while (k >= in->sizes[c])
+                {
+                    k -= in->sizes[c++];
+                }
+                n = in->children[c];
+            }
+            return {this, static_cast<leaf_node const *>(n), static_cast<std::uint16_t>(k)};
+        }
 
-    template <typename Iter>
-    auto
-    advance(Iter begin, int n)
-    {
-        return advance_impl(begin, n, Iter::supports_plus());
-    }
+        // number of elements before `it`
+        std::size_t
+        rank(iterator it) const
+        {
+            if (not it.leaf)
+            {
+                return elements;
+            }
+            std::size_t rank = it.index;
+            for (node const *child = it.leaf; child->parent; child = child->parent)
+            {
+                inner_node const *p = child->parent;
+                for (std::uint16_t c = 0; p->children[c] != child; ++c)
+                {
+                    rank += p->sizes[c];
+                }
+            }
+            return rank;
+        }
 
-} // namespace good_tag_dispatch
+        iterator
+        begin() const
+        {
+            node const *n = root;
+            while (n && not n->is_leaf)
+            {
+                n = static_cast<inner_node const *>(n)->children[0];
+            }
+            auto const *l = static_cast<leaf_node const *>(n);
+            return l && l->count ? iterator{this, l, 0} : end();
+        }
 
-namespace template_auto
-{
-    template <auto... x>
-    struct foo
-    {
-        void
-        f()
+        iterator
+        end() const
         {
-            puts(__PRETTY_FUNCTION__);
+            return {this, nullptr, 0};
         }
-    };
-} // namespace template_auto
 
-namespace variadic_function_templates
-{
-    // Variadic function templates
+        std::size_t
+        size() const
+        {
+            return elements;
+        }
 
-    // Overloaded functions. Template functions cannot be partially specialized!
+      private:
+        static constexpr std::size_t node_bytes = 4 * cache_line_size;
 
-    template <typename T>
-    T
-    min(T a)
-    {
-        return a;
-    }
+        struct inner_node;
 
-    template <typename T>
-    T
-    min(T a, T b)
-    {
-        return a < b ? a : b;
-    }
+        struct node
+        {
+            inner_node   *parent = nullptr;
+            std::uint16_t count  = 0; // keys in a leaf, children in an inner node
+            bool          is_leaf;
+        };
 
-    template <typename T, typename... Ts> // T1, T2, T3, ...
-    T
-    min(T a, Ts... as)                    // T1 a1, T2 a2, T3, a3, ...
-    {
-        return min(a, min(as...));        // a1, a2, a3, ...
-    }
-} // namespace variadic_function_templates
+        static constexpr std::size_t leaf_capacity =
+            std::max<std::size_t>(4, (node_bytes - sizeof(node) - sizeof(void *)) / sizeof(Element));
+        static constexpr std::size_t inner_capacity = std::max<std::size_t>(
+            4, (node_bytes - sizeof(node)) / (sizeof(Element) + sizeof(node *) + sizeof(std::size_t)));
 
-namespace type_sizes
-{
-    template <typename... Ts>
-    auto
-    get_type_sizes()
-    {
-        // sizeof...(Ts) = number of elements in Ts
-        // sizeof(Ts)... = sizeof T1, sizeof T2, sizeof T3, ...
-        return std::array<std::size_t, sizeof...(Ts)>{sizeof(Ts)...};
+        struct alignas(cache_line_size) leaf_node : node
+        {
+            leaf_node() : node{.is_leaf = true}
+            {
+            }
 
-        // return std::array{sizeof(Ts)...}; // same
-    }
-} // namespace type_sizes
+            leaf_node                         *next = nullptr;
+            std::array<Element, leaf_capacity> keys;
+        };
 
-namespace summation
-{
-    template <typename... Ts>
-    std::common_type_t<Ts...>
-    sum(Ts... args)
-    {
-        return (... + args); // unary left fold
-    }
-} // namespace summation
+        // keys[i] separates children[i] and children[i + 1]: everything in children[i + 1] is >= keys[i]
+        struct alignas(cache_line_size) inner_node : node
+        {
+            inner_node() : node{.is_leaf = false}
+            {
+            }
 
-namespace tuple_template
-{
-    // primary
-    template <typename T, typename... Ts>
-    struct tuple
-    {
-        tuple(T const &t, Ts const &...ts) : value(t), rest(ts...)
+            std::array<Element, inner_capacity - 1> keys;
+            std::array<node *, inner_capacity>      children;
+            std::array<std::size_t, inner_capacity> sizes; // elements below each child
+        };
+
+        friend struct tree_iterator<Element>;
+
+        static std::uint16_t
+        child_index(inner_node const *in, Element const &x)
         {
+            return static_cast<std::uint16_t>(std::upper_bound(in->keys.data(), in->keys.data() + in->count - 1, x) -
+                                              in->keys.data());
         }
 
-        constexpr int
-        size() const
+        static std::size_t
+        subtree_size(node const *n)
         {
-            return 1 + rest.size();
+            if (n->is_leaf)
+            {
+                return n->count;
+            }
+            auto const *in = static_cast<inner_node const *>(n);
+            return std::accumulate(in->sizes.begin(), in->sizes.begin() + in->count, std::size_t{0});
         }
 
-        T            value;
-        tuple<Ts...> rest;
-    };
-
-    // partial specialization
-    template <typename T>
-    struct tuple<T>
-    {
-        tuple(const T &t) : value(t)
+        void
+        split(leaf_node *l)
         {
+            auto *r   = new leaf_node;
+            auto  mid = static_cast<std::uint16_t>(l->count / 2);
+            std::copy(l->keys.begin() + mid, l->keys.begin() + l->count, r->keys.begin());
+            r->count = static_cast<std::uint16_t>(l->count - mid);
+            l->count = mid;
+            r->next  = l->next;
+            l->next  = r;
+            insert_child(l, r, r->keys[0]);
         }
 
-        constexpr int
-        size() const
+        void
+        split(inner_node *in)
         {
-            return 1;
+            auto *r   = new inner_node;
+            auto  mid = static_cast<std::uint16_t>(in->count / 2);
+            std::copy(in->children.begin() + mid, in->children.begin() + in->count, r->children.begin());
+            std::copy(in->sizes.begin() + mid, in->sizes.begin() + in->count, r->sizes.begin());
+            std::copy(in->keys.begin() + mid, in->keys.begin() + in->count - 1, r->keys.begin());
+            r->count  = static_cast<std::uint16_t>(in->count - mid);
+            in->count = mid;
+            for (std::uint16_t c = 0; c < r->count; ++c)
+            {
+                r->children[c]->parent = r;
+            }
+            insert_child(in, r, in->keys[mid - 1]); // moves up
         }
 
-        T value;
-    };
+        // makes `right` the sibling after `left` (the parent's total size does not change)
+        void
+        insert_child(node *left, node *right, Element const &separator)
+        {
+            if (not left->parent)
+            {
+                auto *p        = new inner_node;
+                p->count       = 1;
+                p->children[0] = left;
+                p->sizes[0]    = subtree_size(left) + subtree_size(right);
+                left->parent   = p;
+                root           = p;
+            }
+            if (left->parent->count == inner_capacity)
+            {
+                split(left->parent); // may move left to the new sibling
+            }
 
-    // primary
-    template <size_t N, typename T, typename... Ts>
-    struct nth_type : nth_type<N - 1, Ts...> // recursive inheritance
-    {
-        static_assert(N < sizeof...(Ts) + 1, "index out of bounds");
-    };
+            inner_node   *p = left->parent;
+            std::uint16_t i = 0;
+            while (p->children[i] != left)
+            {
+                ++i;
+            }
+            std::move_backward(p->children.begin() + i + 1, p->children.begin() + p->count,
+                               p->children.begin() + p->count + 1);
+            std::move_backward(p->sizes.begin() + i + 1, p->sizes.begin() + p->count, p->sizes.begin() + p->count + 1);
+            std::move_backward(p->keys.begin() + i, p->keys.begin() + p->count - 1, p->keys.begin() + p->count);
+            p->children[i + 1] = right;
+            p->sizes[i]        = subtree_size(left);
+            p->sizes[i + 1]    = subtree_size(right);
+            p->keys[i]         = separator;
+            right->parent      = p;
+            ++p->count;
+        }
 
-    // partial specialization
-    template <typename T, typename... Ts>
-    struct nth_type<0, T, Ts...>
-    {
-        using value_type = T;
+        static void
+        destroy(node *n)
+        {
+            if (not n)
+            {
+                return;
+            }
+            if (n->is_leaf)
+            {
+                delete static_cast<leaf_node *>(n);
+                return;
+            }
+            auto *in = static_cast<inner_node *>(n);
+            for (std::uint16_t c = 0; c < in->count; ++c)
+            {
+                destroy(in->children[c]);
+            }
+            delete in;
+        }
+
+        node       *root     = nullptr;
+        std::size_t elements = 0;
     };
 
-    template <size_t N, typename... Ts>
-    using nth_type_t = nth_type<N, Ts...>::value_type;
+    // vector
 
-    // primary
-    template <size_t N>
-    struct getter
+    template <typename Element>
+    struct vector_iterator
     {
-        template <typename... Ts>
-        static nth_type_t<N, Ts...> &
-        get(tuple<Ts...> &t)
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = std::remove_const_t<Element>;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = Element *;
+        using reference         = Element &;
+        using iterator_concept  = std::contiguous_iterator_tag;
+        using supports_plus     = std::true_type;
+        using is_contiguous     = std::true_type;
+
+        vector_iterator &
+        operator++()
         {
-            return getter<N - 1>::get(t.rest);
+            ++ptr;
+            return *this;
         }
-    };
 
-    // explicit specialization
-    template <>
-    struct getter<0>
-    {
-        template <typename T, typename... Ts>
-        static T &
-        get(tuple<T, Ts...> &t)
+        vector_iterator
+        operator++(int)
         {
-            return t.value;
+            return {ptr++};
         }
-    };
 
-    // API
-    template <size_t N, typename... Ts>
-    nth_type_t<N, Ts...> &
-    get(tuple<Ts...> &t)
-    {
-        return getter<N>::get(t);
-    }
-} // namespace tuple_template
+        vector_iterator &
+        operator--()
+        {
+            --ptr;
+            return *this;
+        }
 
-namespace fold_expressions
+        vector_iterator
+        operator--(int)
+        {
+            return {ptr--};
+        }
+
+        vector_iterator &
+        operator+=(difference_type n)
+        {
+            ptr += n;
+            return *this;
+        }
+
+        vector_iterator &
+        operator-=(difference_type n)
+        {
+            ptr -= n;
+            return *this;
+        }
+
+        friend vector_iterator
+        operator+(vector_iterator it, difference_type n)
+        {
+            return {it.ptr + n};
+        }
+
+        friend vector_iterator
+        operator+(difference_type n, vector_iterator it)
+        {
+            return {it.ptr + n};
+        }
+
+        friend vector_iterator
+        operator-(vector_iterator it, difference_type n)
+        {
+            return {it.ptr - n};
+        }
+
+        friend difference_type
+        operator-(vector_iterator a, vector_iterator b)
+        {
+            return a.ptr - b.ptr;
+        }
+
+        reference
+        operator*() const
+        {
+            return *ptr;
+        }
+
+        pointer
+        operator->() const
+        {
+            return ptr;
+        }
+
+        reference
+        operator[](difference_type n) const
+        {
+            return ptr[n];
+        }
+
+        friend auto
+        operator<=>(vector_iterator, vector_iterator) = default;
+
+        Element *ptr = nullptr;
+    };
+
+    // Vector with room for N elements inside the object: short vectors never allocate, longer ones spill to the
+    // heap. Trivially copyable elements are relocated with memcpy.
+    template <typename T, std::size_t N>
+    class small_vector
+    {
+        static_assert(N > 0, "use std::vector for no inline storage");
+
+      public:
+        using value_type     = T;
+        using iterator       = vector_iterator<T>;
+        using const_iterator = vector_iterator<T const>;
+
+        small_vector() = default;
+
+        // delegating to the default constructor makes the object complete, so if an element's copy throws the
+        // destructor runs and frees what was already built
+        small_vector(std::initializer_list<T> elements) : small_vector()
+        {
+            reserve(elements.size());
+            for (T const &e : elements)
+            {
+                emplace_back(e);
+            }
+        }
+
+        small_vector(small_vector const &other) : small_vector()
+        {
+            reserve(other.size());
+            std::uninitialized_copy(other.begin(), other.end(), data());
+            count = other.count;
+        }
+
+        // steals a heap buffer, relocates inline elements
+        small_vector(small_vector &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            take(other);
+        }
+
+        small_vector &
+        operator=(small_vector const &other)
+        {
+            if (this != &other)
+            {
+                small_vector copy(other);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        small_vector &
+        operator=(small_vector &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            if (this != &other)
+            {
+                release();
+                take(other);
+            }
+            return *this;
+        }
+
+        ~small_vector()
+        {
+            release();
+        }
+
+        template <typename... Args>
+        T &
+        emplace_back(Args &&...args)
+        {
+            if (count == room)
+            {
+                // the new element is constructed first: args may refer to an element of this vector
+                std::size_t const new_room = 2 * room;
+                T                *bigger   = std::allocator<T>{}.allocate(new_room);
+                try
+                {
+                    std::construct_at(bigger + count, std::forward<Args>(args)...);
+                    try
+                    {
+                        relocate(elements, count, bigger);
+                    }
+                    catch (...)
+                    {
+                        std::destroy_at(bigger + count);
+                        throw;
+                    }
+                }
+                catch (...)
+                {
+                    std::allocator<T>{}.deallocate(bigger, new_room);
+                    throw;
+                }
+                adopt(bigger, new_room);
+            }
+            else
+            {
+                std::construct_at(elements + count, std::forward<Args>(args)...);
+            }
+            return elements[count++];
+        }
+
+        void
+        push_back(T const &x)
+        {
+            emplace_back(x);
+        }
+
+        void
+        push_back(T &&x)
+        {
+            emplace_back(std::move(x));
+        }
+
+        void
+        pop_back()
+        {
+            std::destroy_at(elements + --count);
+        }
+
+        void
+        clear()
+        {
+            std::destroy_n(elements, count);
+            count = 0;
+        }
+
+        void
+        reserve(std::size_t n)
+        {
+            if (n > room)
+            {
+                move_to(std::allocator<T>{}.allocate(n), n);
+            }
+        }
+
+        T &
+        operator[](std::size_t i)
+        {
+            return elements[i];
+        }
+
+        T const &
+        operator[](std::size_t i) const
+        {
+            return elements[i];
+        }
+
+        T *
+        data()
+        {
+            return elements;
+        }
+
+        T const *
+        data() const
+        {
+            return elements;
+        }
+
+        std::size_t
+        size() const
+        {
+            return count;
+        }
+
+        std::size_t
+        capacity() const
+        {
+            return room;
+        }
+
+        bool
+        empty() const
+        {
+            return count == 0;
+        }
+
+        // elements still in the object
+        bool
+        is_inline() const
+        {
+            return static_cast<void const *>(elements) == storage;
+        }
+
+        iterator
+        begin()
+        {
+            return {elements};
+        }
+
+        iterator
+        end()
+        {
+            return {elements + count};
+        }
+
+        const_iterator
+        begin() const
+        {
+            return {elements};
+        }
+
+        const_iterator
+        end() const
+        {
+            return {elements + count};
+        }
+
+      private:
+        static constexpr bool memcpy_relocatable = std::is_trivially_copyable_v<T>;
+
+        T *
+        inline_elements()
+        {
+            return reinterpret_cast<T *>(storage);
+        }
+
+        // moves the elements into `to` (capacity `to_room`) and frees the old buffer; `to` is freed if that throws
+        void
+        move_to(T *to, std::size_t to_room)
+        {
+            try
+            {
+                relocate(elements, count, to);
+            }
+            catch (...)
+            {
+                std::allocator<T>{}.deallocate(to, to_room);
+                throw;
+            }
+            adopt(to, to_room);
+        }
+
+        // frees the old buffer, whose elements were relocated to `to`
+        void
+        adopt(T *to, std::size_t to_room)
+        {
+            if (not is_inline())
+            {
+                std::allocator<T>{}.deallocate(elements, room);
+            }
+            elements = to;
+            room     = to_room;
+        }
+
+        static void
+        relocate(T *from, std::size_t n, T *to)
+        {
+            if constexpr (memcpy_relocatable)
+            {
+                if (n)
+                {
+                    std::memcpy(static_cast<void *>(to), from, n * sizeof(T));
+                }
+            }
+            else if constexpr (std::is_nothrow_move_constructible_v<T> || not std::is_copy_constructible_v<T>)
+            {
+                std::uninitialized_move_n(from, n, to);
+                std::destroy_n(from, n);
+            }
+            else // like std::move_if_noexcept: if a copy throws, the originals are untouched
+            {
+                std::uninitialized_copy_n(from, n, to);
+                std::destroy_n(from, n);
+            }
+        }
+
+        // takes over other's elements, leaves other empty and inline; *this must be empty
+        void
+        take(small_vector &other)
+        {
+            if (other.is_inline())
+            {
+                elements = inline_elements();
+                room     = N;
+                relocate(other.elements, other.count, elements);
+            }
+            else
+            {
+                elements = std::exchange(other.elements, other.inline_elements());
+                room     = std::exchange(other.room, N);
+            }
+            count = std::exchange(other.count, 0);
+        }
+
+        void
+        release()
+        {
+            clear();
+            if (not is_inline())
+            {
+                std::allocator<T>{}.deallocate(elements, room);
+            }
+            elements = inline_elements();
+            room     = N;
+        }
+
+        alignas(T) std::byte storage[N * sizeof(T)];
+        T          *elements = inline_elements();
+        std::size_t count    = 0;
+        std::size_t room     = N;
+    };
+
+    template <typename Element, std::size_t N = 16>
+    using vector = small_vector<Element, N>;
+
+    // advance algo
+
+    template <typename Iter>
+    Iter
+    advance_impl(Iter begin, int n, std::false_type)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            ++begin;
+        }
+        return begin;
+    }
+
+    template <typename Iter>
+    Iter
+    advance_impl(Iter begin, int n, std::true_type)
+    {
+        return begin + n;
+    }
+
+    // iterators without + that can still jump in O(log n) declare supports_jump = std::true_type
+    struct logarithmic_tag
+    {
+    };
+
+    template <typename Iter>
+    Iter
+    advance_impl(Iter begin, int n, logarithmic_tag)
+    {
+        return begin.jump(static_cast<std::size_t>(n));
+    }
+
+    template <typename Iter>
+    struct supports_jump : std::false_type
+    {
+    };
+
+    template <typename Iter>
+        requires requires { typename Iter::supports_jump; }
+    struct supports_jump<Iter> : Iter::supports_jump
+    {
+    };
+
+    template <typename Iter>
+    using advance_tag =
+        std::conditional_t<Iter::supports_plus::value, std::true_type,
+                           std::conditional_t<supports_jump<Iter>::value, logarithmic_tag, std::false_type>>;
+
+    template <typename Iter>
+    auto
+    advance(Iter begin, int n)
+    {
+        return advance_impl(begin, n, advance_tag<Iter>());
+    }
+
+    // range algorithms in three tiers:
+    //   element_tag       ++ and * only
+    //   random_access_tag indexed loops (it[i]), which the compiler can unroll and vectorise
+    //   contiguous_tag<T> elements of type T in one block of memory: memmove/memset/memcmp where T allows it
+
+    struct element_tag
+    {
+    };
+
+    struct random_access_tag : element_tag
+    {
+    };
+
+    template <typename T>
+    struct contiguous_tag : random_access_tag
+    {
+        static constexpr bool trivially_copyable    = std::is_trivially_copyable_v<T>;
+        static constexpr bool unique_representation = std::has_unique_object_representations_v<T>; // memcmp ==
+        static constexpr bool byte_ordered = // memcmp ordering (it compares unsigned bytes)
+            std::is_same_v<T, unsigned char> || std::is_same_v<T, std::byte> || std::is_same_v<T, char8_t> ||
+            (std::is_same_v<T, char> && std::is_unsigned_v<char>);
+    };
+
+    // iterators over contiguous memory declare is_contiguous = std::true_type
+    template <typename Iter>
+    struct is_contiguous : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_contiguous<T *> : std::true_type
+    {
+    };
+
+    template <typename Iter>
+        requires requires { typename Iter::is_contiguous; }
+    struct is_contiguous<Iter> : Iter::is_contiguous
+    {
+    };
+
+    // iterators of this file declare supports_plus; others (pointers, standard iterators) count as random access if
+    // they model std::random_access_iterator
+    template <typename Iter>
+    struct is_random_access : std::bool_constant<std::random_access_iterator<Iter>>
+    {
+    };
+
+    template <typename Iter>
+        requires requires { typename Iter::supports_plus; }
+    struct is_random_access<Iter> : Iter::supports_plus
+    {
+    };
+
+    template <typename Iter>
+    using element_t = std::remove_cvref_t<decltype(*std::declval<Iter>())>;
+
+    // the best tier all iterators support (contiguous only if they share the element type)
+    template <typename First, typename... Rest>
+    using algorithm_tag = std::conditional_t<
+        is_contiguous<First>::value && (is_contiguous<Rest>::value && ...) &&
+            (std::is_same_v<element_t<First>, element_t<Rest>> && ...),
+        contiguous_tag<element_t<First>>,
+        std::conditional_t<is_random_access<First>::value && (is_random_access<Rest>::value && ...), random_access_tag,
+                           element_tag>>;
+
+    // copy
+
+    template <typename In, typename Out>
+    Out
+    copy_impl(In first, In last, Out out, element_tag)
+    {
+        for (; first != last; ++first, ++out)
+        {
+            *out = *first;
+        }
+        return out;
+    }
+
+    template <typename In, typename Out>
+    Out
+    copy_impl(In first, In last, Out out, random_access_tag)
+    {
+        auto const n = last - first;
+        for (decltype(last - first) i = 0; i < n; ++i)
+        {
+            out[i] = first[i];
+        }
+        return out + n;
+    }
+
+    template <typename In, typename Out, typename T>
+    Out
+    copy_impl(In first, In last, Out out, contiguous_tag<T>)
+    {
+        if constexpr (contiguous_tag<T>::trivially_copyable)
+        {
+            auto const n = last - first;
+            if (n > 0)
+            {
+                std::memmove(std::to_address(out), std::to_address(first), static_cast<std::size_t>(n) * sizeof(T));
+            }
+            return out + n;
+        }
+        else
+        {
+            return copy_impl(first, last, out, random_access_tag{});
+        }
+    }
+
+    template <typename In, typename Out>
+    Out
+    copy(In first, In last, Out out)
+    {
+        return copy_impl(first, last, out, algorithm_tag<In, Out>());
+    }
+
+    // fill
+
+    template <typename Iter, typename T>
+    void
+    fill_impl(Iter first, Iter last, T const &value, element_tag)
+    {
+        for (; first != last; ++first)
+        {
+            *first = value;
+        }
+    }
+
+    template <typename Iter, typename T>
+    void
+    fill_impl(Iter first, Iter last, T const &value, random_access_tag)
+    {
+        auto const n = last - first;
+        for (decltype(last - first) i = 0; i < n; ++i)
+        {
+            first[i] = value;
+        }
+    }
+
+    template <typename Iter, typename T, typename E>
+    void
+    fill_impl(Iter first, Iter last, T const &value, contiguous_tag<E>)
+    {
+        if constexpr (contiguous_tag<E>::trivially_copyable)
+        {
+            // memset writes one byte value: usable if every byte of the element is the same (any 1-byte type, 0, -1)
+            E const                              element = value;
+            std::array<unsigned char, sizeof(E)> bytes;
+            std::memcpy(bytes.data(), &element, sizeof(E));
+            if (std::ranges::all_of(bytes, [&bytes](unsigned char b) { return b == bytes[0]; }))
+            {
+                if (last - first > 0)
+                {
+                    std::memset(std::to_address(first), bytes[0], static_cast<std::size_t>(last - first) * sizeof(E));
+                }
+                return;
+            }
+        }
+        fill_impl(first, last, value, random_access_tag{});
+    }
+
+    template <typename Iter, typename T>
+    void
+    fill(Iter first, Iter last, T const &value)
+    {
+        fill_impl(first, last, value, algorithm_tag<Iter>());
+    }
+
+    // equal
+
+    template <typename Iter1, typename Iter2>
+    bool
+    equal_impl(Iter1 first1, Iter1 last1, Iter2 first2, element_tag)
+    {
+        for (; first1 != last1; ++first1, ++first2)
+        {
+            if (not(*first1 == *first2))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename Iter1, typename Iter2>
+    bool
+    equal_impl(Iter1 first1, Iter1 last1, Iter2 first2, random_access_tag)
+    {
+        auto const n = last1 - first1;
+        for (decltype(last1 - first1) i = 0; i < n; ++i)
+        {
+            if (not(first1[i] == first2[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // not for floating point (0.0 == -0.0, NaN != NaN) or types with padding: they lack unique representations
+    template <typename Iter1, typename Iter2, typename T>
+    bool
+    equal_impl(Iter1 first1, Iter1 last1, Iter2 first2, contiguous_tag<T>)
+    {
+        if constexpr (contiguous_tag<T>::unique_representation)
+        {
+            auto const n = last1 - first1;
+            return n <= 0 || std::memcmp(std::to_address(first1), std::to_address(first2),
+                                         static_cast<std::size_t>(n) * sizeof(T)) == 0;
+        }
+        else
+        {
+            return equal_impl(first1, last1, first2, random_access_tag{});
+        }
+    }
+
+    template <typename Iter1, typename Iter2>
+    bool
+    equal(Iter1 first1, Iter1 last1, Iter2 first2)
+    {
+        return equal_impl(first1, last1, first2, algorithm_tag<Iter1, Iter2>());
+    }
+
+    // lexicographical_compare
+
+    template <typename Iter1, typename Iter2>
+    bool
+    lexicographical_compare_impl(Iter1 first1, Iter1 last1, Iter2 first2, Iter2 last2, element_tag)
+    {
+        for (; first1 != last1 && first2 != last2; ++first1, ++first2)
+        {
+            if (*first1 < *first2)
+            {
+                return true;
+            }
+            if (*first2 < *first1)
+            {
+                return false;
+            }
+        }
+        return first1 == last1 && first2 != last2;
+    }
+
+    template <typename Iter1, typename Iter2>
+    bool
+    lexicographical_compare_impl(Iter1 first1, Iter1 last1, Iter2 first2, Iter2 last2, random_access_tag)
+    {
+        auto const n1 = last1 - first1;
+        auto const n2 = last2 - first2;
+        auto const n  = std::min(n1, n2);
+        for (decltype(last1 - first1) i = 0; i < n; ++i)
+        {
+            if (first1[i] < first2[i])
+            {
+                return true;
+            }
+            if (first2[i] < first1[i])
+            {
+                return false;
+            }
+        }
+        return n1 < n2;
+    }
+
+    // memcmp orders by unsigned bytes, which is element order only for unsigned byte-sized elements
+    template <typename Iter1, typename Iter2, typename T>
+    bool
+    lexicographical_compare_impl(Iter1 first1, Iter1 last1, Iter2 first2, Iter2 last2, contiguous_tag<T>)
+    {
+        if constexpr (contiguous_tag<T>::byte_ordered)
+        {
+            auto const n1 = last1 - first1;
+            auto const n2 = last2 - first2;
+            auto const n  = std::min(n1, n2);
+            int const  c  = n > 0 ? std::memcmp(std::to_address(first1), std::to_address(first2),
+                                                static_cast<std::size_t>(n))
+                                  : 0;
+            return c < 0 || (c == 0 && n1 < n2);
+        }
+        else
+        {
+            return lexicographical_compare_impl(first1, last1, first2, last2, random_access_tag{});
+        }
+    }
+
+    template <typename Iter1, typename Iter2>
+    bool
+    lexicographical_compare(Iter1 first1, Iter1 last1, Iter2 first2, Iter2 last2)
+    {
+        return lexicographical_compare_impl(first1, last1, first2, last2, algorithm_tag<Iter1, Iter2>());
+    }
+
+} // namespace good_tag_dispatch
+
+namespace template_auto
+{
+    template <auto... x>
+    struct foo
+    {
+        void
+        f()
+        {
+            puts(__PRETTY_FUNCTION__);
+        }
+    };
+} // namespace template_auto
+
+namespace variadic_function_templates
+{
+    // Variadic function templates
+
+    // Overloaded functions. Template functions cannot be partially specialized!
+
+    template <typename T>
+    T
+    min(T a)
+    {
+        return a;
+    }
+
+    template <typename T>
+    T
+    min(T a, T b)
+    {
+        return a < b ? a : b;
+    }
+
+    template <typename T, typename... Ts> // T1, T2, T3, ...
+    T
+    min(T a, Ts... as)                    // T1 a1, T2 a2, T3, a3, ...
+    {
+        return min(a, min(as...));        // a1, a2, a3, ...
+    }
+} // namespace variadic_function_templates
+
+namespace type_sizes
+{
+    template <typename... Ts>
+    auto
+    get_type_sizes()
+    {
+        // sizeof...(Ts) = number of elements in Ts
+        // sizeof(Ts)... = sizeof T1, sizeof T2, sizeof T3, ...
+        return std::array<std::size_t, sizeof...(Ts)>{sizeof(Ts)...};
+
+        // return std::array{sizeof(Ts)...}; // same
+    }
+} // namespace type_sizes
+
+namespace summation
+{
+    template <typename... Ts>
+    std::common_type_t<Ts...>
+    sum(Ts... args)
+    {
+        return (... + args); // unary left fold
+    }
+} // namespace summation
+
+namespace tuple_template
+{
+    // primary
+    template <typename T, typename... Ts>
+    struct tuple
+    {
+        tuple(T const &t, Ts const &...ts) : value(t), rest(ts...)
+        {
+        }
+
+        constexpr int
+        size() const
+        {
+            return 1 + rest.size();
+        }
+
+        T            value;
+        tuple<Ts...> rest;
+    };
+
+    // partial specialization
+    template <typename T>
+    struct tuple<T>
+    {
+        tuple(const T &t) : value(t)
+        {
+        }
+
+        constexpr int
+        size() const
+        {
+            return 1;
+        }
+
+        T value;
+    };
+
+    // primary
+    template <size_t N, typename T, typename... Ts>
+    struct nth_type : nth_type<N - 1, Ts...> // recursive inheritance
+    {
+        static_assert(N < sizeof...(Ts) + 1, "index out of bounds");
+    };
+
+    // partial specialization
+    template <typename T, typename... Ts>
+    struct nth_type<0, T, Ts...>
+    {
+        using value_type = T;
+    };
+
+    template <size_t N, typename... Ts>
+    using nth_type_t = nth_type<N, Ts...>::value_type;
+
+    // primary
+    template <size_t N>
+    struct getter
+    {
+        template <typename... Ts>
+        static nth_type_t<N, Ts...> &
+        get(tuple<Ts...> &t)
+        {
+            return getter<N - 1>::get(t.rest);
+        }
+    };
+
+    // explicit specialization
+    template <>
+    struct getter<0>
+    {
+        template <typename T, typename... Ts>
+        static T &
+        get(tuple<T, Ts...> &t)
+        {
+            return t.value;
+        }
+    };
+
+    // API
+    template <size_t N, typename... Ts>
+    nth_type_t<N, Ts...> &
+    get(tuple<Ts...> &t)
+    {
+        return getter<N>::get(t);
+    }
+} // namespace tuple_template
+
+namespace fold_expressions
+{
+    template <typename... T>
+    void
+    print1(T... args)
+    {
+        (..., (std::cout << args)) << '\n'; // comma operator
+    }
+
+    template <typename... T>
+    void
+    print2(T... args)
+    {
+        (std::cout << ... << args) << '\n'; // binary left fold (init expression = std::cout)
+    }
+
+    template <typename T, typename... Args>
+    void
+    push_back_many(std::vector<T> &v, Args &&...args)
+    {
+        (..., v.push_back(args));
+    }
+} // namespace fold_expressions
+
+namespace factorial_class_template
+{
+    // class template (with static is )
+
+    template <unsigned int N>
+    struct factorial
+    {
+        static constexpr unsigned int value = N * factorial<N - 1>::value;
+    };
+
+    template <>
+    struct factorial<0>
+    {
+        static constexpr unsigned int value = 1;
+    };
+
+    // API
+    template <unsigned int N>
+    constexpr unsigned int factorial_v = factorial<N>::value;
+} // namespace factorial_class_template
+
+namespace factorial_variable_template
+{
+    // variable template (just syntactic sugar for class template with static member)
+
+    template <unsigned int N>
+    constexpr unsigned int factorial = N * factorial<N - 1>;
+
+    template <>
+    constexpr unsigned int factorial<0> = 1;
+} // namespace factorial_variable_template
+
+namespace factorial_function_template
+{
+    // function template
+
+    template <unsigned int n>
+    constexpr unsigned int
+    factorial()
+    {
+        return n * factorial<n - 1>();
+    }
+
+    template <>
+    constexpr unsigned int
+    factorial<0>()
+    {
+        return 1;
+    }
+} // namespace factorial_function_template
+
+namespace factorial_constexpr
+{
+    constexpr unsigned int
+    factorial(unsigned int const n)
+    {
+        return n > 1 ? n * factorial(n - 1) : 1;
+    }
+} // namespace factorial_constexpr
+
+namespace enable_if_template
+{
+    // widget (uses write())
+
+    struct widget
+    {
+        int         id;
+        std::string name;
+
+        std::ostream &
+        write(std::ostream &os) const
+        {
+            os << id << ',' << name << '\n';
+            return os;
+        }
+    };
+
+    // gadget (uses ostream)
+
+    struct gadget
+    {
+        int         id;
+        std::string name;
+
+        friend std::ostream &operator<<(std::ostream &, gadget const &);
+    };
+
+    std::ostream &
+    operator<<(std::ostream &os, gadget const &g)
+    {
+        os << g.id << ',' << g.name << '\n';
+        return os;
+    }
+
+    // uses_write
+    // TODO: Should be part of widget, gadget (but this is about enable_if so we don't care).
+    // TODO: Class template with static member is a variable template.
+
+    template <typename T>
+    struct uses_write
+    {
+        static constexpr bool value = false;
+    };
+
+    template <>
+    struct uses_write<widget>
+    {
+        static constexpr bool value = true;
+    };
+
+    template <typename T>
+    constexpr bool uses_write_v = uses_write<T>::value;
+
+    // enable_if
+
+    template <bool B, typename T = void>
+    struct enable_if
+    {
+    };
+
+    // only for true we have a `type`
+    template <typename T>
+    struct enable_if<true, T>
+    {
+        using type = T;
+    };
+
+    template <bool B, typename T = void>
+    using enable_if_t = enable_if<B, T>::type;
+
+    // serialize
+
+    template <typename T, enable_if_t<uses_write_v<T>> * = nullptr>
+    void
+    serialize(std::ostream &os, T const &value)
+    {
+        value.write(os);
+    }
+
+    template <typename T, enable_if_t<not uses_write_v<T>> * = nullptr>
+    void
+    serialize(std::ostream &os, T const &value)
+    {
+        os << value;
+    }
+} // namespace enable_if_template
+
+namespace sfinae_error
+{
+    // char (*)[N % 2 == 0] either creates char (*)[true] = char(*)[1] or char (*)[false] = char(*)[0].
+    // The latter - array of size 0 - is a SFINAE error.
+    // See https://en.cppreference.com/w/cpp/language/sfinae (lists type errors that are SFINAE errors)
+
+    template <typename T, size_t N>
+    void
+    handle(T (&)[N], char (*)[N % 2 == 0] = nullptr) // accepts array with even number of elements
+    {
+        std::println("handle even array: {} elements", N);
+    }
+
+    template <typename T, size_t N>
+    void
+    handle(T (&)[N], char (*)[N % 2 == 1] = nullptr) // accepts array with odd number of elements
+    {
+        std::println("handle odd  array: {} elements", N);
+    }
+} // namespace sfinae_error
+
+namespace decltype_templates
+{
+    namespace
+    {
+        template <typename T>
+        struct foo
+        {
+            using foo_type = T;
+        };
+
+        template <typename T>
+        struct bar
+        {
+            using bar_type = T;
+        };
+
+        template <typename T>
+        struct dummy
+        {
+            using dummy_type = T;
+        };
+    } // namespace
+
+    namespace
+    {
+        template <typename T>
+        decltype(typename T::foo_type(), void()) // NOTE: comma operator
+        handle(T const &)
+        {
+            std::println("handle a foo");
+        }
+
+        template <typename T>
+        decltype(typename T::bar_type(), void()) // NOTE: comma operator
+        handle(T const &)
+        {
+            std::println("handle a bar");
+        }
+    } // namespace
+} // namespace decltype_templates
+
+namespace common_type
+{
+    namespace
+    {
+        template <typename, typename... Ts>
+        struct has_common_type : std::false_type
+        {
+        };
+
+        template <typename... Ts>
+        struct has_common_type<std::void_t<std::common_type_t<Ts...>>, Ts...> : std::true_type
+        {
+        };
+
+        template <typename... Ts>
+        constexpr bool has_common_type_v = sizeof...(Ts) < 2 || has_common_type<void, Ts...>::value;
+    } // namespace
+
+    template <typename... Ts, typename = std::enable_if_t<has_common_type_v<Ts...>>>
+    void
+    process(Ts &&...)
+    {
+        std::println("{}", demangle(typeid(std::common_type_t<Ts...>).name()));
+    }
+} // namespace common_type
+
+namespace constraints_concepts
+{
+    // A CONSTRAINT is a modern way to define requirements on template parameters.
+    // A CONSTRAINT is a predicate that evaluates to true or false at compile-time.
+    // A CONCEPT is a set of named constraints
+
+    namespace no_check
+    {
+        template <typename T>
+        T
+        add(T const a, T const b)
+        {
+            return a + b;
+        }
+    } // namespace no_check
+
+    namespace enable_if_check
+    {
+        template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+        T
+        add(T const a, T const b)
+        {
+            return a + b;
+        }
+    } // namespace enable_if_check
+
+    namespace static_assert_check
+    {
+        template <typename T>
+        T
+        add(T const a, T const b)
+        {
+            static_assert(std::is_arithmetic_v<T>, "Arithmetic type required");
+            return a + b;
+        }
+    } // namespace static_assert_check
+
+    namespace requires_check
+    {
+        // REQUIRES CLAUSE doesn't use curly braces.
+
+        template <typename T>
+            requires std::is_arithmetic_v<T>
+        T
+        add(T const a, T const b)
+        {
+            return a + b;
+        }
+    } // namespace requires_check
+
+    namespace requires_check_alternative
+    {
+        // the same, only different order (matter of personal taste)
+
+        template <typename T>
+        T
+        add(T const a, T const b)
+            requires std::is_arithmetic_v<T>
+        {
+            return a + b;
+        }
+    } // namespace requires_check_alternative
+
+    namespace concept_check
+    {
+        // REQUIRES EXPRESSION uses curly braces.
+        // A requires expression is a Boolean expression that can be used with a requires clause.
+
+        template <typename T>
+        concept arithmetic = requires { std::is_arithmetic_v<T>; };
+
+        template <arithmetic T> // used like a data type
+        T
+        add(T const a, T const b)
+        {
+            return a + b;
+        }
+    } // namespace concept_check
+
+    namespace concept_check_alternative
+    {
+        // simple requirement (doesn't use `requires` keyword)
+        template <typename T>
+        concept arithmetic = std::is_arithmetic_v<T>;
+
+        template <arithmetic T>
+        T
+        add(T const a, T const b)
+        {
+            return a + b;
+        }
+    } // namespace concept_check_alternative
+
+    namespace old_requirements_style
+    {
+        // old style
+        template <typename T, typename U = void>
+        struct is_container : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct is_container<T, std::void_t<typename T::value_type,               //
+                                           typename T::size_type,                //
+                                           typename T::allocator_type,           //
+                                           typename T::iterator,                 //
+                                           typename T::const_iterator,           //
+                                           decltype(std::declval<T>().size()),   //
+                                           decltype(std::declval<T>().begin()),  //
+                                           decltype(std::declval<T>().end()),    //
+                                           decltype(std::declval<T>().cbegin()), //
+                                           decltype(std::declval<T>().cend())>>  //
+            : std::true_type
+        {
+        };
+
+        template <typename T, typename U = void>
+        constexpr bool is_container_v = is_container<T, U>::value;
+    } // namespace old_requirements_style
+
+    namespace new_requirements_style
+    {
+        // NOTE: naming convention (`container` instead of `is_container` bc it's used like a data type)
+        template <typename T>
+        concept container = requires(T t) {
+            typename T::value_type;     // type requirement
+            typename T::size_type;      // ..
+            typename T::allocator_type; // ..
+            typename T::iterator;       // ..
+            typename T::const_iterator; // type requirement
+            t.size();                   // simple requirement
+            t.begin();                  // ..
+            t.end();                    // ..
+            t.cbegin();                 // ..
+            t.cend();                   // simple requirement
+        };
+
+        template <container C>
+        void
+        process(C &&)
+        {
+            // ...
+        }
+    } // namespace new_requirements_style
+} // namespace constraints_concepts
+
+namespace simple_requirements
+{
+    // syntax: requires (parameter-list) { requirement-seq }
+
+    template <typename T>
+    concept arithmetic = requires { std::is_arithmetic_v<T>; };
+
+    template <typename T>
+    concept arithmetic_alt = std::is_arithmetic_v<T>; // empty parameter list can be omitted
+
+    template <typename T>
+    concept addable = requires(T a, T b) { a + b; };
+
+    template <typename T>
+    concept logger = requires(T t) {
+        t.error("just"); // takes a single parameter of `const char*` or some type that can be constructed from it
+        t.warning("a");  // the actual values passed as arguments have no importance (they are never performed)
+        t.info("demo");  // they are only checked for type correctness
+    };
+
+    template <logger Logger>
+    void
+    log_error(Logger &l)
+    {
+        l.error("error");
+        l.warning("warning");
+        l.info("info");
+    }
+
+    struct console_logger
+    {
+        void
+        error(std::string_view msg)
+        {
+            std::cout << msg << '\n';
+        }
+
+        void
+        warning(std::string_view msg)
+        {
+            std::cout << msg << '\n';
+        }
+
+        void
+        info(std::string_view msg)
+        {
+            std::cout << msg << '\n';
+        }
+    };
+} // namespace simple_requirements
+
+namespace compound_requirement
+{
+    namespace
+    {
+        template <typename T>
+        void
+        f(T) noexcept // doesn't throw errors
+        {
+            // ...
+        }
+
+        template <typename T>
+        void
+        g(T) // could throw errors
+        {
+            // ...
+        }
+    } // namespace
+
+    namespace
+    {
+        // We want to check an expression for exceptions and/or return types.
+        // Syntax: { expression } [noexcept] [-> type_constraint];
+        // (both `noexcept` and `type_constraint` are optional)
+
+        template <typename F, typename... Args>
+        concept NonThrowing = requires(F &&func, Args... args) {
+            { func(args...) } noexcept; // checking for noexcept specifier
+        };
+
+        template <typename F, typename... Args>
+            requires NonThrowing<F, Args...>
+        void
+        invoke(F &&func, Args... args)
+        {
+            func(args...);
+        }
+    } // namespace
+} // namespace compound_requirement
+
+namespace check_for_return_types
+{
+    // checking for return values (must be a type constraint; not the actual return type)
+
+    template <typename T>
+    concept timer = requires(T t) {
+        { t.start() } -> std::same_as<void>;            // start() returns void
+        { t.stop() } -> std::convertible_to<long long>; // stop() returns anything convertible to long long
+    };
+
+    struct timerA
+    {
+        void
+        start()
+        {
+            // ...
+        }
+
+        int
+        // long long
+        stop()
+        {
+            return 0;
+        }
+    };
+} // namespace check_for_return_types
+
+namespace benchmarking
+{
+    // A stopwatch that models the `timer` concept: start() returns void, stop() returns elapsed nanoseconds.
+
+    struct stopwatch
+    {
+        void
+        start()
+        {
+            begin = std::chrono::steady_clock::now();
+        }
+
+        long long
+        stop()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - begin;
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+
+      private:
+        std::chrono::steady_clock::time_point begin;
+    };
+
+    static_assert(check_for_return_types::timer<stopwatch>);
+
+    // keeps the optimizer from discarding (or constant-folding) a benchmarked value
+    template <typename T>
+    void
+    do_not_optimize(T const &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // average nanoseconds per call of `f` over `repeat` calls
+    template <check_for_return_types::timer Timer = stopwatch, typename F>
+    double
+    measure(F &&f, std::size_t repeat = 1)
+    {
+        Timer t;
+        t.start();
+        for (std::size_t i = 0; i < repeat; ++i)
+        {
+            f();
+        }
+        return static_cast<double>(t.stop()) / static_cast<double>(repeat);
+    }
+} // namespace benchmarking
+
+namespace nested_requirements
+{
+    // std::conjunction_v performs a logical AND on the sequence of traits.
+    template <typename T, typename... Ts>
+    constexpr bool are_same_v = std::conjunction_v<std::is_same<T, Ts>...>;
+
+    template <typename... T>
+    concept HomogenousRange = requires(T... t) { // `requires`
+        (... + t);                               // simple requirement (no `requires`)
+        requires are_same_v<T...>;               // nested requirement: `requires` inside `requires`
+        requires sizeof...(T) > 1;               // nested requirement: `requires` inside `requires`
+    };
+
+    template <typename... T>
+        requires HomogenousRange<T...>
+    auto
+    add(T &&...t)
+    {
+        return (... + t);
+    }
+} // namespace nested_requirements
+
+namespace simd_homogenous_range
+{
+    // A HomogenousRange has a single element type, so the pack can be packed into a std::array<T, N>,
+    // loaded into vector registers and reduced with vertical ops followed by a horizontal reduction.
+
+    using nested_requirements::HomogenousRange;
+
+    // register width is picked at compile time from the target's instruction set
+#if defined(__AVX512F__)
+    constexpr std::size_t register_bytes = 64;
+#elif defined(__AVX__)
+    constexpr std::size_t register_bytes = 32;
+#else
+    constexpr std::size_t register_bytes = 16; // SSE2 (x86-64 baseline) or NEON
+#endif
+
+    template <typename T>
+    concept vectorizable = std::is_arithmetic_v<T> && not std::is_same_v<T, bool> && sizeof(T) <= 8;
+
+    // as many lanes as fit into a register, but no more than the (rounded up) number of elements
+    template <vectorizable T, std::size_t N>
+    constexpr std::size_t lanes = std::max<std::size_t>(2, std::min(register_bytes / sizeof(T), std::bit_ceil(N)));
+
+    // GCC/Clang vector extension: L elements of T in one register
+    template <typename T, std::size_t L>
+    struct vector_register
+    {
+        typedef T type __attribute__((vector_size(sizeof(T) * L)));
+    };
+
+    template <typename T, std::size_t L>
+    using vector_register_t = vector_register<T, L>::type;
+
+    // operations work on scalars and vector registers alike (GCC/Clang support ?: on vectors)
+    struct plus
+    {
+        template <typename T>
+        static constexpr T identity = T{0};
+
+        auto
+        operator()(auto a, auto b) const
+        {
+            return a + b;
+        }
+    };
+
+    struct multiplies
+    {
+        template <typename T>
+        static constexpr T identity = T{1};
+
+        auto
+        operator()(auto a, auto b) const
+        {
+            return a * b;
+        }
+    };
+
+    struct minimum
+    {
+        template <typename T>
+        static constexpr T identity = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                                           : std::numeric_limits<T>::max();
+
+        auto
+        operator()(auto a, auto b) const
+        {
+            return a < b ? a : b;
+        }
+    };
+
+    struct maximum
+    {
+        template <typename T>
+        static constexpr T identity = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                                           : std::numeric_limits<T>::lowest();
+
+        auto
+        operator()(auto a, auto b) const
+        {
+            return a < b ? b : a;
+        }
+    };
+
+    // horizontal reduction: fold the upper half of the register onto the lower half until two lanes are left
+    template <typename T, std::size_t L, typename Op>
+    T
+    horizontal(vector_register_t<T, L> v, Op op)
+    {
+        if constexpr (L == 2)
+        {
+            return op(v[0], v[1]);
+        }
+        else
+        {
+            using half = vector_register_t<T, L / 2>;
+            half lo, hi;
+            std::memcpy(&lo, &v, sizeof(half));
+            std::memcpy(&hi, reinterpret_cast<char const *>(&v) + sizeof(half), sizeof(half));
+            return horizontal<T, L / 2>(op(lo, hi), op);
+        }
+    }
+
+    // N values padded with the identity up to a multiple of the lane count
+    template <vectorizable T, std::size_t N, typename Op>
+    T
+    reduce(std::array<T, N> const &values, Op op)
+    {
+        constexpr std::size_t L = lanes<T, N>;
+        constexpr std::size_t P = (N + L - 1) / L * L;
+        using vec               = vector_register_t<T, L>;
+
+        alignas(vec) std::array<T, P> padded;
+        std::copy(values.begin(), values.end(), padded.begin());
+        std::fill(padded.begin() + N, padded.end(), Op::template identity<T>);
+
+        vec acc;
+        std::memcpy(&acc, padded.data(), sizeof(vec));
+        for (std::size_t i = L; i < P; i += L) // vertical ops, L elements at a time
+        {
+            vec next;
+            std::memcpy(&next, padded.data() + i, sizeof(vec));
+            acc = op(acc, next);
+        }
+        return horizontal<T, L>(acc, op);
+    }
+
+    // API
+
+    template <typename... T>
+        requires HomogenousRange<T...>
+    auto
+    pack(T... t)
+    {
+        return std::array{t...};
+    }
+
+    // NOTE: floating-point results may differ from a left fold in the last bits (different association)
+    template <typename... T>
+        requires HomogenousRange<T...>
+    auto
+    add(T... t)
+    {
+        return reduce(pack(t...), plus{});
+    }
+
+    template <typename... T>
+        requires HomogenousRange<T...>
+    auto
+    mul(T... t)
+    {
+        return reduce(pack(t...), multiplies{});
+    }
+
+    template <typename... T>
+        requires HomogenousRange<T...>
+    auto
+    min(T... t)
+    {
+        return reduce(pack(t...), minimum{});
+    }
+
+    template <typename... T>
+        requires HomogenousRange<T...>
+    auto
+    max(T... t)
+    {
+        return reduce(pack(t...), maximum{});
+    }
+
+    template <vectorizable T, std::size_t N>
+    T
+    dot(std::array<T, N> const &a, std::array<T, N> const &b)
+    {
+        constexpr std::size_t L = lanes<T, N>;
+        constexpr std::size_t P = (N + L - 1) / L * L;
+        using vec               = vector_register_t<T, L>;
+
+        alignas(vec) std::array<T, P> pa{}; // zero padding doesn't change the dot product
+        alignas(vec) std::array<T, P> pb{};
+        std::copy(a.begin(), a.end(), pa.begin());
+        std::copy(b.begin(), b.end(), pb.begin());
+
+        vec acc{};
+        for (std::size_t i = 0; i < P; i += L)
+        {
+            vec x, y;
+            std::memcpy(&x, pa.data() + i, sizeof(vec));
+            std::memcpy(&y, pb.data() + i, sizeof(vec));
+            acc += x * y;
+        }
+        return horizontal<T, L>(acc, plus{});
+    }
+
+    // scalar left fold (nested_requirements::add) vs. SIMD reduction; both called with N arguments
+    template <typename T, std::size_t N>
+    void
+    benchmark_add(std::size_t iterations)
+    {
+        std::array<T, N> values;
+        std::iota(values.begin(), values.end(), T{1});
+
+        auto run = [&](auto reduction) {
+            return benchmarking::measure(
+                [&] {
+                    benchmarking::do_not_optimize(values); // values are opaque: no constant folding
+                    benchmarking::do_not_optimize(std::apply(reduction, values));
+                },
+                iterations);
+        };
+
+        double fold = run([](auto... t) { return nested_requirements::add(t...); });
+        double simd = run([](auto... t) { return add(t...); });
+
+        std::println("N = {:2}: fold {:.2f} ns, simd {:.2f} ns", N, fold, simd);
+    }
+} // namespace simd_homogenous_range
+
+namespace composing_constraints_1
+{
+    // Composing constraints
+
+    // with && (conjunction) and || (disjunction); short-circuited
+
+    template <typename T>
+        requires std::is_integral_v<T> && std::is_signed_v<T>
+    T
+    decrement(T value)
+    {
+        return --value;
+    }
+} // namespace composing_constraints_1
+
+namespace composing_constraints_2
+{
+    template <typename T>
+    concept Integral = std::is_integral_v<T>;
+
+    template <typename T>
+    concept Signed = std::is_signed_v<T>;
+
+    template <typename T>
+    concept SignedIntegral = Integral<T> && Signed<T>;
+
+    template <SignedIntegral T>
+    T
+    decrement(T value)
+    {
+        return --value;
+    }
+} // namespace composing_constraints_2
+
+namespace integer_codec
+{
+    // Compression of sorted and near-sorted integer columns:
+    //   delta   - store differences between neighbours instead of the values
+    //   zigzag  - map signed deltas to unsigned codes so small magnitudes get small codes
+    //   packing - store each block of 128 codes with the bit width of its largest code
+
+    using composing_constraints_2::Integral;
+    using composing_constraints_2::SignedIntegral;
+
+    // zigzag: 0, -1, 1, -2, 2, ... -> 0, 1, 2, 3, 4, ...
+
+    template <SignedIntegral T>
+    constexpr std::make_unsigned_t<T>
+    zigzag_encode(T value)
+    {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<U>(static_cast<U>(value) << 1) ^ static_cast<U>(value >> std::numeric_limits<T>::digits);
+    }
+
+    template <std::unsigned_integral U>
+    constexpr std::make_signed_t<U>
+    zigzag_decode(U code)
+    {
+        return static_cast<std::make_signed_t<U>>(static_cast<U>(code >> 1) ^ static_cast<U>(-(code & 1)));
+    }
+
+    static_assert(zigzag_encode(0) == 0u && zigzag_encode(-1) == 1u && zigzag_encode(1) == 2u);
+    static_assert(zigzag_decode(zigzag_encode(std::numeric_limits<int>::min())) == std::numeric_limits<int>::min());
+
+    // delta: computed with wrap-around in the unsigned type so it works for signed and unsigned columns
+
+    template <Integral T>
+    constexpr std::make_unsigned_t<T>
+    delta_encode(T value, T previous)
+    {
+        using U = std::make_unsigned_t<T>;
+        auto const difference = static_cast<U>(static_cast<U>(value) - static_cast<U>(previous));
+        return zigzag_encode(static_cast<std::make_signed_t<T>>(difference));
+    }
+
+    template <Integral T>
+    constexpr T
+    delta_decode(std::make_unsigned_t<T> code, T previous)
+    {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(static_cast<U>(previous) + static_cast<U>(zigzag_decode(code))));
+    }
+
+    // Bit-packing with a vertical layout: the 128 codes of a block are spread over the lanes of a 128-bit register
+    // (code i goes to lane i % lanes), and every lane packs its codes independently. Packing and unpacking then
+    // do the same shift/mask on all lanes at once, so the lane loops vectorize. A block of width w takes
+    // exactly 16 * w bytes for every element size.
+
+    constexpr std::size_t block_size = 128;
+
+    template <std::unsigned_integral U>
+    constexpr std::size_t lanes = 16 / sizeof(U);
+
+    template <std::unsigned_integral U>
+    void
+    pack_block(U const *codes, unsigned width, U *out)
+    {
+        constexpr unsigned    bits     = std::numeric_limits<U>::digits;
+        constexpr std::size_t L        = lanes<U>;
+        constexpr std::size_t per_lane = block_size / L;
+
+        if (width == 0)
+        {
+            return;
+        }
+
+        std::fill(out, out + width * L, U{0});
+        for (std::size_t j = 0; j < per_lane; ++j)
+        {
+            std::size_t const word     = j * width / bits;
+            unsigned const    shift    = j * width % bits;
+            bool const        straddle = shift + width > bits;
+            for (std::size_t lane = 0; lane < L; ++lane)
+            {
+                U const code = codes[j * L + lane];
+                out[word * L + lane] |= static_cast<U>(code << shift);
+                if (straddle)
+                {
+                    out[(word + 1) * L + lane] |= static_cast<U>(code >> (bits - shift));
+                }
+            }
+        }
+    }
+
+    template <std::unsigned_integral U>
+    void
+    unpack_block(U const *in, unsigned width, U *codes)
+    {
+        constexpr unsigned    bits     = std::numeric_limits<U>::digits;
+        constexpr std::size_t L        = lanes<U>;
+        constexpr std::size_t per_lane = block_size / L;
+
+        if (width == 0)
+        {
+            std::fill(codes, codes + block_size, U{0});
+            return;
+        }
+
+        U const mask = width == bits ? static_cast<U>(~U{0}) : static_cast<U>((U{1} << width) - 1);
+        for (std::size_t j = 0; j < per_lane; ++j)
+        {
+            std::size_t const word  = j * width / bits;
+            unsigned const    shift = j * width % bits;
+            if (shift + width > bits)
+            {
+                for (std::size_t lane = 0; lane < L; ++lane)
+                {
+                    U const lo          = static_cast<U>(in[word * L + lane] >> shift);
+                    U const hi          = static_cast<U>(in[(word + 1) * L + lane] << (bits - shift));
+                    codes[j * L + lane] = static_cast<U>(lo | hi) & mask;
+                }
+            }
+            else
+            {
+                for (std::size_t lane = 0; lane < L; ++lane)
+                {
+                    codes[j * L + lane] = static_cast<U>(in[word * L + lane] >> shift) & mask;
+                }
+            }
+        }
+    }
+
+    // A compressed column. Every block stores its first value, so blocks can be decoded independently.
+
+    template <Integral T>
+    class column
+    {
+        using U = std::make_unsigned_t<T>;
+
+        struct block_header
+        {
+            T             base;   // first value of the block
+            std::uint32_t offset; // index of the block's first word
+            std::uint8_t  width;  // bits per code
+        };
+
+        std::size_t               count = 0;
+        std::vector<block_header> headers;
+        std::vector<U>            words;
+
+      public:
+        static column
+        encode(std::span<T const> values)
+        {
+            column c;
+            c.count = values.size();
+
+            std::array<U, block_size> codes;
+            for (std::size_t first = 0; first < values.size(); first += block_size)
+            {
+                std::size_t const n = std::min(block_size, values.size() - first);
+
+                T previous = values[first];
+                U all_bits = 0;
+                for (std::size_t i = 0; i < block_size; ++i) // tail of the last block is padded with zero deltas
+                {
+                    T const value = i < n ? values[first + i] : previous;
+                    codes[i]      = delta_encode(value, previous);
+                    all_bits |= codes[i];
+                    previous = value;
+                }
+
+                auto const width = static_cast<std::uint8_t>(std::bit_width(all_bits));
+                if (c.words.size() > std::numeric_limits<std::uint32_t>::max())
+                {
+                    throw std::length_error{"integer_codec::column: packed words exceed the 32-bit block offset"};
+                }
+                c.headers.push_back({values[first], static_cast<std::uint32_t>(c.words.size()), width});
+                c.words.resize(c.words.size() + width * lanes<U>);
+                pack_block(codes.data(), width, c.words.data() + c.headers.back().offset);
+            }
+            return c;
+        }
+
+        std::size_t
+        size() const
+        {
+            return count;
+        }
+
+        std::size_t
+        block_count() const
+        {
+            return headers.size();
+        }
+
+        std::size_t
+        compressed_bytes() const
+        {
+            return headers.size() * sizeof(block_header) + words.size() * sizeof(U);
+        }
+
+        // random block access: decodes block `b` into `out` (needs room for block_size values),
+        // returns the number of values in the block
+        std::size_t
+        decode_block(std::size_t b, std::span<T> out) const
+        {
+            block_header const &h = headers[b];
+            std::size_t const   n = std::min(block_size, count - b * block_size);
+
+            std::array<U, block_size> codes;
+            unpack_block(words.data() + h.offset, h.width, codes.data());
+
+            T previous = h.base;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                previous = delta_decode(codes[i], previous);
+                out[i]   = previous;
+            }
+            return n;
+        }
+
+        // decodes the whole column into `out` (needs room for size() values)
+        void
+        decode(std::span<T> out) const
+        {
+            for (std::size_t b = 0; b < headers.size(); ++b)
+            {
+                if ((b + 1) * block_size <= count)
+                {
+                    decode_block(b, out.subspan(b * block_size, block_size));
+                }
+                else // last, partial block
+                {
+                    std::array<T, block_size> tail;
+                    std::size_t const         n = decode_block(b, tail);
+                    std::copy_n(tail.begin(), n, out.begin() + b * block_size);
+                }
+            }
+        }
+    };
+
+    // compression ratio and decode throughput of a column
+    template <Integral T>
+    void
+    report(std::string_view name, std::vector<T> const &values)
+    {
+        auto const     c = column<T>::encode(values);
+        std::vector<T> decoded(values.size());
+
+        double const ns    = benchmarking::measure([&] { c.decode(decoded); }, 10);
+        double const bytes = static_cast<double>(values.size() * sizeof(T));
+
+        std::println("{:<12} ratio {:.2f}, decode {:.2f} GB/s, round trip {}", name,
+                     bytes / static_cast<double>(c.compressed_bytes()), bytes / ns,
+                     decoded == values ? "ok" : "FAILED");
+    }
+} // namespace integer_codec
+
+namespace constrain_template_parameter_packs
+{
+    // Conjunctions and disjunctions cannot be used to constrain template parameter packs.
+
+    template <typename... T>
+    //  requires std::is_integral_v<T> && ...  // error: this is not allowed
+        requires(std::is_integral_v<T> && ...) // now it's a fold expression of type-traits! (But: no short-circuiting!)
+    auto
+    add(T... args)
+    {
+        return (args + ...);
+    }
+} // namespace constrain_template_parameter_packs
+
+namespace concept_template_parameter_packs
+{
+    // we just give the thing a name (concept = named constraint)
+    template <typename T>
+    concept Integral = std::is_integral_v<T>; // RHS = boolean value
+
+    // and now it works
+    template <typename... T>
+        requires(Integral<T> && ...) // fold with concepts creates a conjunction (WITH short-circuiting!)
+    auto
+    add(T... args)
+    {
+        return (args + ...);
+    }
+} // namespace concept_template_parameter_packs
+
+namespace static_loops
+{
+    // Compile-time unrolled loops built on index sequences and fold expressions.
+    // Inspect with `-O2 -S`: static_for expands to straight-line code (no counter, no compare/jump), and
+    // unroll<K> has one compare-and-branch per K elements plus the scalar tail.
+
+    namespace detail
+    {
+        template <std::size_t Begin, std::size_t Step, typename F, std::size_t... Is>
+        constexpr void
+        static_for_impl(F &&f, std::index_sequence<Is...>)
+        {
+            (f(std::integral_constant<std::size_t, Begin + Is * Step>{}), ...); // comma fold: one call per index
+        }
+    } // namespace detail
+
+    // calls f(std::integral_constant<std::size_t, I>{}) for I = Begin, Begin + Step, ... < End
+    template <std::size_t Begin, std::size_t End, std::size_t Step = 1, typename F>
+    constexpr void
+    static_for(F &&f)
+    {
+        static_assert(Step > 0, "Step must be positive");
+        constexpr std::size_t count = End > Begin ? (End - Begin + Step - 1) / Step : 0;
+        detail::static_for_impl<Begin, Step>(f, std::make_index_sequence<count>{});
+    }
+
+    // calls f(i) for i in [0, n): the body is unrolled K times, the remaining n % K calls form a scalar tail
+    template <std::size_t K, typename F>
+    constexpr void
+    unroll(std::size_t n, F &&f)
+    {
+        std::size_t i = 0;
+        for (; i + K <= n; i += K)
+        {
+            static_for<0, K>([&](auto j) { f(i + j); });
+        }
+        for (; i < n; ++i)
+        {
+            f(i);
+        }
+    }
+
+    // calls f(element) for every element of a tuple (or anything std::apply accepts)
+    template <typename Tuple, typename F>
+    constexpr void
+    for_each_in_tuple(Tuple &&t, F &&f)
+    {
+        std::apply([&f](auto &&...elements) { (f(std::forward<decltype(elements)>(elements)), ...); },
+                   std::forward<Tuple>(t));
+    }
+
+    // dot products
+
+    template <typename T>
+    T
+    dot_loop(std::span<T const> a, std::span<T const> b)
+    {
+        T sum{};
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    template <std::size_t K, typename T>
+    T
+    dot_unroll(std::span<T const> a, std::span<T const> b)
+    {
+        T sum{};
+        unroll<K>(a.size(), [&](std::size_t i) { sum += a[i] * b[i]; });
+        return sum;
+    }
+
+    // K independent accumulators break the dependency chain on `sum` (which the compiler must keep for floats)
+    template <std::size_t K, typename T>
+    T
+    dot_static_for(std::span<T const> a, std::span<T const> b)
+    {
+        std::array<T, K> acc{};
+        std::size_t      i = 0;
+        for (; i + K <= a.size(); i += K)
+        {
+            static_for<0, K>([&](auto j) { acc[j] += a[i + j] * b[i + j]; });
+        }
+
+        T tail{};
+        for (; i < a.size(); ++i)
+        {
+            tail += a[i] * b[i];
+        }
+        return std::apply([](auto... x) { return (x + ...); }, acc) + tail;
+    }
+} // namespace static_loops
+
+namespace anonymous_concepts_1
+{
+    template <typename T>
+    concept addable = requires(T a, T b) { a + b; }; // requires expression
+
+    template <typename T>
+        requires addable<T>                          // requires clause with concept
+    auto
+    add(T a, T b)
+    {
+        return a + b;
+    }
+} // namespace anonymous_concepts_1
+
+namespace anonymous_concepts_2
+{
+    // confusing syntax (requires requires ...); prefer n637a
+
+    template <typename T>
+    //                "anonymous concept"
+    //           ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+        requires requires(T a, T b) { a + b; } // requires clause with requires expression
+    auto
+    add(T a, T b)
+    {
+        return a + b;
+    }
+} // namespace anonymous_concepts_2
+
+namespace abbreviated_function_template
+{
+    // In C++20 you can use the auto specifier in the function parameter list.
+    // This has the effect of transforming the function into a template function.
+    // Such a function using auto for function parameters is called an ABBREVIATED FUNCTION TEMPLATE.
+
+    // abbreviated function template
+    auto
+    add(auto a, auto b)
+    {
+        return a + b;
+    }
+} // namespace abbreviated_function_template
+
+namespace constrained_abbreviated_function_template
+{
+    // constrained abbreviated function template (using concepts)
+    auto
+    add(std::integral auto a, std::integral auto b)
+    {
+        return a + b;
+    }
+} // namespace constrained_abbreviated_function_template
+
+namespace constrained_abbreviated_variadic_function_template
+{
+    // constrained auto can also be used for variadic function templates
+
+    auto
+    add(std::integral auto... args)
+    {
+        return (args + ...);
+    }
+} // namespace constrained_abbreviated_variadic_function_template
+
+namespace constrained_auto_with_lambdas
+{
+    // constrained auto with generic lambdas (C++14)
+    auto sum = [](std::integral auto a, std::integral auto b) { return a + b; };
+
+    // constrained auto with templated lambdas (C++20)
+    auto twice = []<std::integral T>(T a) { return a + a; };
+
+} // namespace constrained_auto_with_lambdas
+
+namespace parallel_transform_lambdas
+{
+    // Applies (constrained) lambdas like `sum` and `twice` to whole ranges: the range is split into chunks that
+    // fit into the L2 cache, the chunks run on a thread pool, and each chunk is a plain loop the compiler can
+    // auto-vectorize.
+
+    class thread_pool
+    {
+      public:
+        explicit thread_pool(unsigned n = std::max(1u, std::thread::hardware_concurrency()))
+        {
+            for (unsigned i = 0; i < n; ++i)
+            {
+                workers.emplace_back([this](std::stop_token st) { work(st); });
+            }
+        }
+
+        ~thread_pool()
+        {
+            for (auto &w : workers)
+            {
+                w.request_stop();
+            }
+            ready.notify_all();
+        }
+
+        void
+        submit(std::function<void()> task)
+        {
+            {
+                std::scoped_lock lock{mutex};
+                tasks.push_back(std::move(task));
+            }
+            ready.notify_one();
+        }
+
+        std::size_t
+        size() const
+        {
+            return workers.size();
+        }
+
+        // true inside a task of this pool: waiting there for other tasks of the pool can deadlock it
+        bool
+        on_worker_thread() const
+        {
+            return current == this;
+        }
+
+      private:
+        void
+        work(std::stop_token st)
+        {
+            current = this;
+            while (true)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock{mutex};
+                    if (not ready.wait(lock, st, [this] { return not tasks.empty(); }))
+                    {
+                        return; // stop requested
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        static inline thread_local thread_pool const *current = nullptr; // pool the calling thread works for
+
+        std::mutex                        mutex;
+        std::condition_variable_any       ready;
+        std::deque<std::function<void()>> tasks;
+        std::vector<std::jthread>         workers; // last member: threads stop before the queue goes away
+    };
+
+    inline thread_pool &
+    default_pool()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    inline std::size_t
+    l2_cache_bytes()
+    {
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+        if (long bytes = ::sysconf(_SC_LEVEL2_CACHE_SIZE); bytes > 0)
+        {
+            return static_cast<std::size_t>(bytes);
+        }
+#endif
+        return 1 << 20; // 1 MiB is a reasonable guess for current x86 and ARM cores
+    }
+
+    // number of elements per task: input and output of a chunk should fill about half of L2
+    template <typename In, typename Out>
+    std::size_t
+    grain_size()
+    {
+        return std::max<std::size_t>(4096, l2_cache_bytes() / 2 / (sizeof(In) + sizeof(Out)));
+    }
+
+    // the constraint of `f` is checked against the range's value_type at compile time
+    template <typename F, typename R>
+    concept applicable_to = std::ranges::random_access_range<R> && std::ranges::sized_range<R> &&
+                            std::copy_constructible<F> && std::invocable<F &, std::ranges::range_value_t<R>>;
+
+    template <typename R, typename Out, typename F>
+        requires applicable_to<F, R> && std::ranges::random_access_range<Out> && std::ranges::sized_range<Out> &&
+                 std::indirectly_writable<std::ranges::iterator_t<Out>,
+                                          std::invoke_result_t<F &, std::ranges::range_value_t<R>>>
+    void
+    parallel_transform(R &&range, Out &&out, F f, thread_pool &pool = default_pool())
+    {
+        using in_type  = std::ranges::range_value_t<R>;
+        using out_type = std::ranges::range_value_t<Out>;
+
+        auto const n     = static_cast<std::size_t>(std::ranges::size(range));
+        auto const grain = grain_size<in_type, out_type>();
+        if (static_cast<std::size_t>(std::ranges::size(out)) < n)
+        {
+            throw std::length_error{"parallel_transform: output range is shorter than the input"};
+        }
+
+        // every chunk calls its own copy of `f`, so a stateful callable is never shared between workers
+        auto chunk = [&range, &out, &f](std::size_t first, std::size_t last) {
+            F fn = f;
+            if constexpr (std::ranges::contiguous_range<R> && std::ranges::contiguous_range<Out>)
+            {
+                auto const *src = std::ranges::data(range);
+                auto       *dst = std::ranges::data(out);
+                for (std::size_t i = first; i < last; ++i) // simple counted loop over pointers: vectorizable
+                {
+                    dst[i] = fn(src[i]);
+                }
+            }
+            else
+            {
+                auto src = std::ranges::begin(range);
+                auto dst = std::ranges::begin(out);
+                std::transform(src + first, src + last, dst + first, fn);
+            }
+        };
+
+        // a call from one of the pool's own tasks runs inline: waiting for the chunks would block a worker
+        std::size_t const chunks = (n + grain - 1) / grain;
+        if (chunks <= 1 or pool.size() <= 1 or pool.on_worker_thread())
+        {
+            chunk(0, n);
+            return;
+        }
+
+        std::latch         done{static_cast<std::ptrdiff_t>(chunks)};
+        std::exception_ptr error;
+        std::once_flag     first_error;
+        for (std::size_t first = 0; first < n; first += grain)
+        {
+            pool.submit([&, first] {
+                try
+                {
+                    chunk(first, std::min(first + grain, n));
+                }
+                catch (...)
+                {
+                    std::call_once(first_error, [&] { error = std::current_exception(); });
+                }
+                done.count_down();
+            });
+        }
+        done.wait();
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+} // namespace parallel_transform_lambdas
+
+namespace crtp
+{
+    // The Curiously Recurring Template Pattern
+
+    // general form:
+    // A: X<A>
+
+    namespace
+    {
+        template <typename T>
+        struct Base
+        {
+            void
+            f()
+            {
+                // this->do_f();                // error: No member named 'do_f' in 'Base<T>'
+
+                // calling function in derived class
+                static_cast<T *>(this)->do_f(); // upcast to 'Derived *'
+            }
+        };
+
+        struct Derived : public Base<Derived>   // CRTP
+        {
+            void
+            do_f()
+            {
+                std::println("Derived::f()");
+            }
+        };
+    } // namespace
+
+    template <typename T>
+    void
+    process(Base<T> &b)
+    {
+        b.f();
+    }
+} // namespace crtp
+
+namespace crtp_pipeline
+{
+    // Processing stages in the style of crtp::Base: `process` forwards to `Derived::do_process` through a
+    // static_cast, so there is no virtual dispatch. Stages compose at compile time (`source | filter | map | sink`)
+    // into a single fused type; the whole chain is one loop body the compiler can inline across.
+
+    struct record
+    {
+        std::uint64_t key;
+        double        value;
+    };
+
+    template <typename Derived>
+    struct stage
+    {
+        // returns false to drop the record
+        bool
+        process(record &r)
+        {
+            return static_cast<Derived *>(this)->do_process(r); // like crtp::Base::f() -> Derived::do_f()
+        }
+    };
+
+    template <typename Derived>
+    struct source
+    {
+        // fills the batch, returns the number of records produced (0 = exhausted)
+        std::size_t
+        fill(std::span<record> batch)
+        {
+            return static_cast<Derived *>(this)->do_fill(batch);
+        }
+    };
+
+    template <typename T>
+    concept Stage = std::derived_from<T, stage<T>>;
+
+    template <typename T>
+    concept Source = std::derived_from<T, source<T>>;
+
+    // two stages fused into one
+    template <Stage First, Stage Second>
+    struct fused : stage<fused<First, Second>>
+    {
+        fused(First f, Second s) : first(std::move(f)), second(std::move(s))
+        {
+        }
+
+        bool
+        do_process(record &r)
+        {
+            return first.process(r) && second.process(r); // short-circuits on dropped records
+        }
+
+        First  first;
+        Second second;
+    };
+
+    // a source with its fused chain of stages
+    template <Source S, Stage Chain>
+    struct pipeline
+    {
+        S     src;
+        Chain chain;
+
+        void
+        run(std::size_t batch_size = 256)
+        {
+            std::vector<record> batch(batch_size);
+            while (std::size_t n = src.fill(batch))
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    chain.process(batch[i]);
+                }
+            }
+        }
+    };
+
+    template <Stage A, Stage B>
+    auto
+    operator|(A a, B b)
+    {
+        return fused<A, B>{std::move(a), std::move(b)};
+    }
+
+    template <Source S, Stage A>
+    auto
+    operator|(S s, A a)
+    {
+        return pipeline<S, A>{std::move(s), std::move(a)};
+    }
+
+    template <Source S, Stage Chain, Stage A>
+    auto
+    operator|(pipeline<S, Chain> p, A a)
+    {
+        return pipeline<S, fused<Chain, A>>{std::move(p.src), {std::move(p.chain), std::move(a)}};
+    }
+
+    // stages
+
+    struct counter : source<counter>
+    {
+        std::uint64_t next = 0;
+        std::uint64_t last;
+
+        explicit counter(std::uint64_t n) : last(n)
+        {
+        }
+
+        std::size_t
+        do_fill(std::span<record> batch)
+        {
+            std::size_t n = std::min<std::uint64_t>(batch.size(), last - next);
+            for (std::size_t i = 0; i < n; ++i, ++next)
+            {
+                batch[i] = {next, static_cast<double>(next)};
+            }
+            return n;
+        }
+    };
+
+    template <typename Pred>
+    struct filter_stage : stage<filter_stage<Pred>>
+    {
+        explicit filter_stage(Pred p) : pred(std::move(p))
+        {
+        }
+
+        bool
+        do_process(record &r)
+        {
+            return pred(r);
+        }
+
+        Pred pred;
+    };
+
+    template <typename F>
+    struct map_stage : stage<map_stage<F>>
+    {
+        explicit map_stage(F fn) : f(std::move(fn))
+        {
+        }
+
+        bool
+        do_process(record &r)
+        {
+            f(r);
+            return true;
+        }
+
+        F f;
+    };
+
+    struct sum_sink : stage<sum_sink>
+    {
+        double *total;
+
+        explicit sum_sink(double &t) : total(&t)
+        {
+        }
+
+        bool
+        do_process(record &r)
+        {
+            *total += r.value;
+            return true;
+        }
+    };
+
+    auto
+    filter(auto pred)
+    {
+        return filter_stage{std::move(pred)};
+    }
+
+    auto
+    map(auto f)
+    {
+        return map_stage{std::move(f)};
+    }
+
+    // N identical map stages fused into one
+    template <std::size_t N>
+    auto
+    maps()
+    {
+        auto scale = map([](record &r) { r.value = r.value * 0.5 + 1.0; });
+        if constexpr (N == 1)
+        {
+            return scale;
+        }
+        else
+        {
+            return scale | maps<N - 1>();
+        }
+    }
+
+    // the same pipeline with virtual dispatch
+
+    namespace dynamic
+    {
+        struct stage
+        {
+            virtual ~stage() = default;
+
+            virtual bool process(record &r) = 0;
+        };
+
+        struct filter_even : stage
+        {
+            bool
+            process(record &r) override
+            {
+                return r.key % 2 == 0;
+            }
+        };
+
+        struct scale : stage
+        {
+            bool
+            process(record &r) override
+            {
+                r.value = r.value * 0.5 + 1.0;
+                return true;
+            }
+        };
+
+        struct sum_sink : stage
+        {
+            double *total;
+
+            explicit sum_sink(double &t) : total(&t)
+            {
+            }
+
+            bool
+            process(record &r) override
+            {
+                *total += r.value;
+                return true;
+            }
+        };
+
+        inline void
+        run(counter src, std::vector<std::unique_ptr<stage>> const &stages, std::size_t batch_size = 256)
+        {
+            std::vector<record> batch(batch_size);
+            while (std::size_t n = src.fill(batch))
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    for (auto const &s : stages)
+                    {
+                        if (not s->process(batch[i]))
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    } // namespace dynamic
+
+    // static vs. virtual pipeline: source | filter | N maps | sink
+    template <std::size_t N>
+    void
+    benchmark(std::uint64_t records)
+    {
+        double static_total  = 0;
+        double dynamic_total = 0;
+
+        auto fused_pipeline = counter{records} | filter([](record &r) { return r.key % 2 == 0; }) | maps<N>() |
+                              sum_sink{static_total};
+
+        std::vector<std::unique_ptr<dynamic::stage>> stages;
+        stages.push_back(std::make_unique<dynamic::filter_even>());
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            stages.push_back(std::make_unique<dynamic::scale>());
+        }
+        stages.push_back(std::make_unique<dynamic::sum_sink>(dynamic_total));
+
+        double fused_ns   = benchmarking::measure([&] { auto p = fused_pipeline; p.run(); });
+        double virtual_ns = benchmarking::measure([&] { dynamic::run(counter{records}, stages); });
+
+        std::println("{:2} stages: fused {:.2f} ms, virtual {:.2f} ms, same result: {}", N, fused_ns / 1e6,
+                     virtual_ns / 1e6, static_total == dynamic_total);
+    }
+} // namespace crtp_pipeline
+
+namespace crtp_instrumentation
+{
+    // Mixins that count, time or trace calls of `do_f`-style hooks without editing them. Like crtp::Base::f()
+    // they forward to the derived class through a static_cast. Compile with -DCRTP_INSTRUMENTATION=0 and the
+    // mixins compile to a plain call.
+
+#ifndef CRTP_INSTRUMENTATION
+#define CRTP_INSTRUMENTATION 1
+#endif
+
+    constexpr bool instrumentation_enabled = CRTP_INSTRUMENTATION;
+
+    // One counter per thread (shard), each on its own cache line; aggregated when read.
+    class sharded_counter
+    {
+      public:
+        static constexpr std::size_t shards = 64;
+
+        void
+        add(std::uint64_t n = 1)
+        {
+            slots[shard()].value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        std::uint64_t
+        load() const
+        {
+            std::uint64_t sum = 0;
+            for (auto const &s : slots)
+            {
+                sum += s.value.load(std::memory_order_relaxed);
+            }
+            return sum;
+        }
+
+      private:
+        struct alignas(cache_line_size) slot
+        {
+            std::atomic<std::uint64_t> value{0};
+        };
+
+        // threads get shards round-robin on first use
+        static std::size_t
+        shard()
+        {
+            static std::atomic<std::size_t> next{0};
+            thread_local std::size_t const  id = next.fetch_add(1, std::memory_order_relaxed) % shards;
+            return id;
+        }
+
+        std::array<slot, shards> slots;
+    };
+
+    // stands in for sharded_counter when instrumentation is disabled
+    struct no_counter
+    {
+        void
+        add(std::uint64_t = 1)
+        {
+        }
+
+        std::uint64_t
+        load() const
+        {
+            return 0;
+        }
+    };
+
+    using counter = std::conditional_t<instrumentation_enabled, sharded_counter, no_counter>;
+
+    // counted: number of calls (per Derived type)
+
+    template <typename Derived>
+    struct counted
+    {
+        void
+        f()
+        {
+            invoke(&Derived::do_f);
+        }
+
+        template <typename Hook, typename... Args>
+        decltype(auto)
+        invoke(Hook hook, Args &&...args)
+        {
+            calls.add();
+            return std::invoke(hook, static_cast<Derived &>(*this), std::forward<Args>(args)...);
+        }
+
+        static std::uint64_t
+        call_count()
+        {
+            return calls.load();
+        }
+
+      private:
+        static inline counter calls;
+    };
+
+    // timed: number of calls and total time spent in them (per Derived type)
+
+    template <typename Derived>
+    struct timed
+    {
+        void
+        f()
+        {
+            invoke(&Derived::do_f);
+        }
+
+        template <typename Hook, typename... Args>
+        decltype(auto)
+        invoke(Hook hook, Args &&...args)
+        {
+            if constexpr (instrumentation_enabled)
+            {
+                struct stop_on_exit // records the time even if the hook returns a value or throws
+                {
+                    benchmarking::stopwatch watch;
+
+                    ~stop_on_exit()
+                    {
+                        calls.add();
+                        nanoseconds.add(static_cast<std::uint64_t>(watch.stop()));
+                    }
+                } guard;
+                guard.watch.start();
+                return std::invoke(hook, static_cast<Derived &>(*this), std::forward<Args>(args)...);
+            }
+            else
+            {
+                return std::invoke(hook, static_cast<Derived &>(*this), std::forward<Args>(args)...);
+            }
+        }
+
+        static std::uint64_t
+        call_count()
+        {
+            return calls.load();
+        }
+
+        static std::uint64_t
+        total_ns()
+        {
+            return nanoseconds.load();
+        }
+
+      private:
+        static inline counter calls;
+        static inline counter nanoseconds;
+    };
+
+    // traced: prints entry and exit of every call
+
+    template <typename Derived>
+    struct traced
+    {
+        void
+        f()
+        {
+            invoke(&Derived::do_f);
+        }
+
+        template <typename Hook, typename... Args>
+        decltype(auto)
+        invoke(Hook hook, Args &&...args)
+        {
+            if constexpr (instrumentation_enabled)
+            {
+                struct leave_on_exit
+                {
+                    ~leave_on_exit()
+                    {
+                        std::println("<- {}", name());
+                    }
+                } guard;
+                std::println("-> {}", name());
+                return std::invoke(hook, static_cast<Derived &>(*this), std::forward<Args>(args)...);
+            }
+            else
+            {
+                return std::invoke(hook, static_cast<Derived &>(*this), std::forward<Args>(args)...);
+            }
+        }
+
+      private:
+        static std::string const &
+        name()
+        {
+            static std::string const n = demangle(typeid(Derived).name());
+            return n;
+        }
+    };
+
+    // instrumenting crtp::Derived::do_f() without touching it
+    struct counted_derived : crtp::Derived, counted<counted_derived>
+    {
+        using counted<counted_derived>::f; // hide crtp::Base::f()
+    };
+
+    struct traced_derived : crtp::Derived, traced<traced_derived>
+    {
+        using traced<traced_derived>::f;
+    };
+} // namespace crtp_instrumentation
+
+namespace polymorphism_benchmark
+{
+    // Static vs. dynamic polymorphism, measured: the same tiny member function called through
+    //   crtp        - crtp::process(Base<T>&) over a homogeneous vector (only possible for a single type)
+    //   virtual     - vector<unique_ptr<Base>>
+    //   variant     - vector<variant<...>> + std::visit
+    //   partitioned - one vector per type, each processed with crtp::process (CRTP for mixed types)
+    //   function    - vector<std::function<void()>>
+    // for mixes of one, two and eight types in random order.
+
+    constexpr std::size_t type_count = 8;
+
+    template <std::size_t K>
+    struct shape : crtp::Base<shape<K>>
+    {
+        double value = 1.0;
+
+        void
+        do_f()
+        {
+            value = value * 0.5 + static_cast<double>(K);
+        }
+    };
+
+    struct virtual_shape
+    {
+        virtual ~virtual_shape() = default;
+
+        virtual void do_f() = 0;
+    };
+
+    template <std::size_t K>
+    struct virtual_shape_k : virtual_shape
+    {
+        double value = 1.0;
+
+        void
+        do_f() override
+        {
+            value = value * 0.5 + static_cast<double>(K);
+        }
+    };
+
+    template <typename Seq>
+    struct shape_types;
+
+    template <std::size_t... K>
+    struct shape_types<std::index_sequence<K...>>
+    {
+        using variant     = std::variant<shape<K>...>;
+        using partitioned = std::tuple<std::vector<shape<K>>...>;
+    };
+
+    using any_shape   = shape_types<std::make_index_sequence<type_count>>::variant;
+    using partitioned = shape_types<std::make_index_sequence<type_count>>::partitioned;
+
+    // turns a run-time type index into a compile-time one: f(std::integral_constant<std::size_t, K>)
+    template <typename F>
+    void
+    with_kind(std::size_t kind, F &&f)
+    {
+        static_loops::static_for<0, type_count>([&](auto k) {
+            if (k == kind)
+            {
+                f(k);
+            }
+        });
+    }
+
+    // hardware event counter (Linux perf_event_open); stop() returns -1 if the event is not available
+#if defined(__linux__)
+    class perf_counter
+    {
+      public:
+        perf_counter(std::uint32_t type, std::uint64_t config)
+        {
+            perf_event_attr attr{};
+            attr.size           = sizeof(attr);
+            attr.type           = type;
+            attr.config         = config;
+            attr.disabled       = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            fd                  = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        perf_counter(perf_counter const &)            = delete;
+        perf_counter &operator=(perf_counter const &) = delete;
+
+        ~perf_counter()
+        {
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+        }
+
+        void
+        start()
+        {
+            if (fd >= 0)
+            {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+
+        long long
+        stop()
+        {
+            long long count = -1;
+            if (fd >= 0)
+            {
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                if (::read(fd, &count, sizeof(count)) != sizeof(count))
+                {
+                    count = -1;
+                }
+            }
+            return count;
+        }
+
+      private:
+        int fd = -1;
+    };
+
+    inline perf_counter
+    branch_misses()
+    {
+        return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+    }
+
+    inline perf_counter
+    icache_misses()
+    {
+        return {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1I | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+    }
+#else
+    struct perf_counter
+    {
+        void
+        start()
+        {
+        }
+
+        long long
+        stop()
+        {
+            return -1;
+        }
+    };
+
+    inline perf_counter
+    branch_misses()
+    {
+        return {};
+    }
+
+    inline perf_counter
+    icache_misses()
+    {
+        return {};
+    }
+#endif
+
+    struct result
+    {
+        double    ns;
+        long long branch_misses;
+        long long icache_misses;
+    };
+
+    template <typename F>
+    result
+    run(F &&f)
+    {
+        f(); // warm up caches and predictors
+
+        perf_counter            branches = branch_misses();
+        perf_counter            icache   = icache_misses();
+        benchmarking::stopwatch watch;
+
+        branches.start();
+        icache.start();
+        watch.start();
+        f();
+        double const ns = static_cast<double>(watch.stop());
+        return {ns, branches.stop(), icache.stop()};
+    }
+
+    inline void
+    print_row(std::string_view mix, std::string_view strategy, result const &r, std::size_t objects)
+    {
+        auto per_object = [objects](long long count) {
+            return count < 0 ? "n/a"s : std::to_string(static_cast<double>(count) / static_cast<double>(objects));
+        };
+        std::println("{:<8} {:<12} {:>12.2f} {:>14} {:>14}", mix, strategy, r.ns / static_cast<double>(objects),
+                     per_object(r.branch_misses), per_object(r.icache_misses));
+    }
+
+    // `objects` from 1M to 100M; `types` = number of different types in the (random) mix
+    inline void
+    benchmark(std::size_t objects, std::size_t types)
+    {
+        std::mt19937                               rng{42};
+        std::uniform_int_distribution<std::size_t> pick{0, types - 1};
+        std::vector<std::size_t>                   kinds(objects);
+        std::generate(kinds.begin(), kinds.end(), [&] { return pick(rng); });
+
+        std::vector<std::unique_ptr<virtual_shape>> pointers;
+        std::vector<any_shape>                      variants;
+        partitioned                                 partitions;
+        std::vector<std::function<void()>>          functions;
+        pointers.reserve(objects);
+        variants.reserve(objects);
+        functions.reserve(objects);
+
+        for (std::size_t kind : kinds)
+        {
+            with_kind(kind, [&](auto k) {
+                pointers.push_back(std::make_unique<virtual_shape_k<k>>());
+                variants.emplace_back(shape<k>{});
+                std::get<k>(partitions).emplace_back();
+                functions.emplace_back([s = shape<k>{}]() mutable { s.do_f(); });
+            });
+        }
+
+        auto crtp_calls = [&] {
+            for (auto &s : std::get<0>(partitions))
+            {
+                crtp::process(s);
+            }
+        };
+
+        auto virtual_calls = [&] {
+            for (auto &p : pointers)
+            {
+                p->do_f();
+            }
+        };
+
+        auto variant_calls = [&] {
+            for (auto &v : variants)
+            {
+                std::visit([](auto &s) { s.do_f(); }, v);
+            }
+        };
+
+        auto partitioned_calls = [&] {
+            static_loops::for_each_in_tuple(partitions, [](auto &partition) {
+                for (auto &s : partition)
+                {
+                    crtp::process(s);
+                }
+            });
+        };
+
+        auto function_calls = [&] {
+            for (auto &f : functions)
+            {
+                f();
+            }
+        };
+
+        std::string const mix = std::to_string(types) + (types == 1 ? " type" : " types");
+
+        if (types == 1) // CRTP needs a single static type
+        {
+            print_row(mix, "crtp", run(crtp_calls), objects);
+        }
+        print_row(mix, "virtual", run(virtual_calls), objects);
+        print_row(mix, "variant", run(variant_calls), objects);
+        print_row(mix, "partitioned", run(partitioned_calls), objects);
+        print_row(mix, "function", run(function_calls), objects);
+    }
+} // namespace polymorphism_benchmark
+
+namespace limited_number
+{
+    namespace
+    {
+        // hint to the CPU that we are busy-waiting
+        inline void
+        cpu_relax()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+
+        // Preallocated storage for exactly N objects of T. Every slot sits on its own cache line(s); free slots
+        // form a lock-free stack (Treiber stack) whose head carries a tag against the ABA problem.
+        // A counting semaphore tracks the free slots, so callers can also wait for one instead of failing.
+        template <typename T, size_t N>
+        class object_pool
+        {
+          public:
+            object_pool()
+            {
+                for (std::uint32_t i = 0; i < N; ++i)
+                {
+                    slots[i].next.store(i + 1, std::memory_order_relaxed); // N = end of list
+                }
+            }
+
+            object_pool(object_pool const &)            = delete;
+            object_pool &operator=(object_pool const &) = delete;
+
+            // storage for one T, nullptr if all slots are taken
+            void *
+            try_acquire()
+            {
+                return available.try_acquire() ? pop() : nullptr;
+            }
+
+            // storage for one T; spins briefly, then blocks until a slot is released
+            void *
+            acquire()
+            {
+                for (int i = 0; i < spin_count; ++i)
+                {
+                    if (available.try_acquire())
+                    {
+                        return pop();
+                    }
+                    cpu_relax();
+                }
+                available.acquire();
+                return pop();
+            }
+
+            // storage for one T, nullptr if no slot was released within `timeout`
+            template <typename Rep, typename Period>
+            void *
+            acquire_for(std::chrono::duration<Rep, Period> const &timeout)
+            {
+                return available.try_acquire_for(timeout) ? pop() : nullptr;
+            }
+
+            void
+            release(void *p)
+            {
+                push(p);
+                available.release();
+            }
+
+          private:
+            static constexpr int spin_count = 64;
+
+            // a successful semaphore acquire guarantees a free slot
+            void *
+            pop()
+            {
+                std::uint64_t head = free.load(std::memory_order_acquire);
+                while (true)
+                {
+                    std::uint32_t index = index_of(head);
+                    std::uint64_t next = make_head(slots[index].next.load(std::memory_order_relaxed), tag_of(head) + 1);
+                    if (free.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+                    {
+                        return slots[index].storage;
+                    }
+                }
+            }
+
+            void
+            push(void *p)
+            {
+                auto         *s     = reinterpret_cast<slot *>(static_cast<std::byte *>(p) - offsetof(slot, storage));
+                std::uint32_t index = static_cast<std::uint32_t>(s - slots.data());
+                std::uint64_t head  = free.load(std::memory_order_relaxed);
+                std::uint64_t next;
+                do
+                {
+                    s->next.store(index_of(head), std::memory_order_relaxed);
+                    next = make_head(index, tag_of(head) + 1);
+                } while (not free.compare_exchange_weak(head, next, std::memory_order_release,
+                                                        std::memory_order_relaxed));
+            }
+
+            struct alignas(std::max(cache_line_size, alignof(T))) slot
+            {
+                alignas(T) std::byte       storage[sizeof(T)];
+                std::atomic<std::uint32_t> next;
+            };
+
+            // head of the free list: slot index (low 32 bits) and a tag incremented on every change (high 32 bits)
+            static std::uint64_t
+            make_head(std::uint32_t index, std::uint32_t tag)
+            {
+                return std::uint64_t{tag} << 32 | index;
+            }
+
+            static std::uint32_t
+            index_of(std::uint64_t head)
+            {
+                return static_cast<std::uint32_t>(head);
+            }
+
+            static std::uint32_t
+            tag_of(std::uint64_t head)
+            {
+                return static_cast<std::uint32_t>(head >> 32);
+            }
+
+            std::array<slot, N> slots;
+
+            alignas(cache_line_size) std::atomic<std::uint64_t> free{make_head(0, 0)}; // not sharing a slot's line
+            alignas(cache_line_size) std::counting_semaphore<N> available{N};
+        };
+    } // namespace
+
+    namespace
+    {
+        // Live metrics of one limited_instances<T, N> instantiation. Constructions and rejections go to sharded
+        // per-thread counters, the high-water mark is only written when it grows; reading sums the shards and
+        // never writes, so it doesn't slow down construction.
+        struct instance_metrics;
+
+        inline std::atomic<instance_metrics *> metrics_registry{nullptr};
+
+        struct instance_metrics
+        {
+            // registers itself; lives as long as the program (function-local static)
+            instance_metrics(std::string (*name)(), size_t n, std::atomic<size_t> const *count)
+                : type_name(name), limit(n), current(count)
+            {
+                next = metrics_registry.load(std::memory_order_relaxed);
+                while (not metrics_registry.compare_exchange_weak(next, this, std::memory_order_release,
+                                                                  std::memory_order_relaxed))
+                {
+                }
+            }
+
+            std::string (*type_name)(); // demangled lazily, on read
+            size_t                     limit;
+            std::atomic<size_t> const *current;
+
+            alignas(cache_line_size) std::atomic<size_t> high_water{0};
+            crtp_instrumentation::sharded_counter constructions;
+            crtp_instrumentation::sharded_counter rejections;
+
+            instance_metrics *next = nullptr; // registry: lock-free, push-only list of all instantiations
+
+            void
+            record_construction(size_t live)
+            {
+                constructions.add();
+                size_t high = high_water.load(std::memory_order_relaxed);
+                while (live > high && not high_water.compare_exchange_weak(high, live, std::memory_order_relaxed))
+                {
+                }
+            }
+        };
+
+        struct metrics_snapshot
+        {
+            std::string   type;
+            size_t        limit;
+            size_t        current;
+            size_t        high_water;
+            std::uint64_t constructions;
+            std::uint64_t rejections;
+        };
+
+        // metrics of all instantiations, in one pass over the registry
+        inline std::vector<metrics_snapshot>
+        snapshot()
+        {
+            std::vector<metrics_snapshot> result;
+            for (auto *m = metrics_registry.load(std::memory_order_acquire); m; m = m->next)
+            {
+                result.push_back({m->type_name(), m->limit, m->current->load(std::memory_order_relaxed),
+                                  m->high_water.load(std::memory_order_relaxed), m->constructions.load(),
+                                  m->rejections.load()});
+            }
+            return result;
+        }
+
+        template <typename T>
+        std::string
+        type_name()
+        {
+            return demangle(typeid(T).name());
+        }
+    } // namespace
+
+    namespace
+    {
+        // limiting number of instances of T to N
+        template <typename T, size_t N>
+        struct limited_instances
+        {
+            // on its own cache line, so counters of different instantiations don't share one
+            struct alignas(cache_line_size) counter
+            {
+                std::atomic<size_t>        value;           // live instances
+                std::counting_semaphore<N> admissions{N}; // free admissions: the limit itself
+            };
+
+            static counter count; // every instantiation has its own static count!
+
+            limited_instances()
+            {
+                size_t live = std::exchange(admitted, 0); // non-zero if a pool policy already took the admission
+                if (live == 0 and (live = admit()) == 0)
+                {
+                    metrics().rejections.add();
+                    throw std::logic_error{"Too many instances"};
+                }
+                metrics().record_construction(live);
+            }
+
+            // a copy is another instance
+            limited_instances(limited_instances const &) : limited_instances()
+            {
+            }
+
+            ~limited_instances()
+            {
+                dismiss();
+            }
+
+            // Takes one of the N admissions, returns the live count including it or 0 if all are taken. The
+            // semaphore checks and takes in one atomic step (a separate `if (count >= N)` and `++count` lets two
+            // threads pass the check together and exceed N).
+            static size_t
+            admit()
+            {
+                return count.admissions.try_acquire() ? enter() : 0;
+            }
+
+            // blocks until an admission is free (direct instances hold admissions without holding a pool slot)
+            static size_t
+            admit_wait()
+            {
+                count.admissions.acquire();
+                return enter();
+            }
+
+            // 0 if no admission was freed before `deadline`
+            template <typename Clock, typename Duration>
+            static size_t
+            admit_until(std::chrono::time_point<Clock, Duration> const &deadline)
+            {
+                return count.admissions.try_acquire_until(deadline) ? enter() : 0;
+            }
+
+            // gives an admission back, waking a waiter if there is one
+            static void
+            dismiss()
+            {
+                count.value.fetch_sub(1, std::memory_order_relaxed);
+                count.admissions.release();
+            }
+
+            // admission taken by a pool policy for the object it is about to construct on this thread
+            static inline thread_local size_t admitted = 0;
+
+            // pool mode: storage for exactly N objects (see make<T>())
+            static object_pool<T, N> &
+            pool()
+            {
+                static object_pool<T, N> p;
+                return p;
+            }
+
+            // registered in the metrics registry on first use
+            static instance_metrics &
+            metrics()
+            {
+                static instance_metrics m{&type_name<T>, N, &count.value};
+                return m;
+            }
+
+          private:
+            // counts an instance under an admission already taken, returns the live count including it
+            static size_t
+            enter()
+            {
+                return count.value.fetch_add(1, std::memory_order_relaxed) + 1;
+            }
+        };
+
+        // init of non-const static data member
+        template <typename T, size_t N>
+        limited_instances<T, N>::counter limited_instances<T, N>::count{0};
+    } // namespace
+
+    namespace
+    {
+        struct excalibur : limited_instances<excalibur, 1>
+        {
+            // ...
+        };
+
+        struct book_of_magic : limited_instances<book_of_magic, 3>
+        {
+            // ...
+        };
+    } // namespace
+
+    namespace
+    {
+        // Owning handle to an object in its type's pool; destroying the handle releases the slot.
+        template <typename T>
+        class pooled
+        {
+          public:
+            explicit pooled(T *p) : ptr(p)
+            {
+            }
+
+            pooled(pooled &&other) noexcept : ptr(std::exchange(other.ptr, nullptr))
+            {
+            }
+
+            pooled &
+            operator=(pooled &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    reset();
+                    ptr = std::exchange(other.ptr, nullptr);
+                }
+                return *this;
+            }
+
+            ~pooled()
+            {
+                reset();
+            }
+
+            void
+            reset()
+            {
+                if (ptr)
+                {
+                    ptr->~T();
+                    T::pool().release(std::exchange(ptr, nullptr));
+                }
+            }
+
+            T *
+            get() const
+            {
+                return ptr;
+            }
+
+            T *
+            operator->() const
+            {
+                return ptr;
+            }
+
+            T &
+            operator*() const
+            {
+                return *ptr;
+            }
+
+            explicit
+            operator bool() const
+            {
+                return ptr != nullptr;
+            }
+
+          private:
+            T *ptr;
+        };
+
+        // Constructs T in a slot of T's pool (which must come from T::pool()) under an admission that was already
+        // taken, so the constructor doesn't check the limit again; no heap allocation.
+        template <typename T, typename... Args>
+        pooled<T>
+        construct_in(void *slot, size_t admission, Args &&...args)
+        {
+            T::admitted = admission;
+            try
+            {
+                return pooled<T>{::new (slot) T(std::forward<Args>(args)...)};
+            }
+            catch (...)
+            {
+                if (std::exchange(T::admitted, 0) != 0) // thrown before limited_instances was constructed
+                {
+                    T::dismiss();
+                }
+                T::pool().release(slot);
+                throw;
+            }
+        }
+
+        // admission and slot together, nullptr if either is taken
+        template <typename T>
+        std::pair<void *, size_t>
+        try_reserve()
+        {
+            size_t const live = T::admit();
+            if (live == 0) // pooled or direct instances hold the admissions
+            {
+                return {nullptr, 0};
+            }
+            void *slot = T::pool().try_acquire();
+            if (not slot) // a released instance may not have returned its slot yet
+            {
+                T::dismiss();
+                return {nullptr, 0};
+            }
+            return {slot, live};
+        }
+
+        // Acquire policies for pooled instances. Only `make` throws when the limit is hit. Instances created
+        // outside the pool count towards the same N, so a policy takes an admission first and a slot second: every
+        // slot holder holds an admission, so with one in hand a slot is free or about to be.
+
+        // throws if all admissions or slots are taken
+        template <typename T, typename... Args>
+        pooled<T>
+        make(Args &&...args)
+        {
+            auto const [slot, live] = try_reserve<T>();
+            if (not slot)
+            {
+                T::metrics().rejections.add();
+                throw std::logic_error{"Too many instances"};
+            }
+            return construct_in<T>(slot, live, std::forward<Args>(args)...);
+        }
+
+        // empty optional if all admissions or slots are taken
+        template <typename T, typename... Args>
+        std::optional<pooled<T>>
+        try_acquire(Args &&...args)
+        {
+            auto const [slot, live] = try_reserve<T>();
+            if (not slot)
+            {
+                T::metrics().rejections.add();
+                return std::nullopt;
+            }
+            return construct_in<T>(slot, live, std::forward<Args>(args)...);
+        }
+
+        // waits until an admission is free, then for its slot (spin, then park on the semaphore)
+        template <typename T, typename... Args>
+        pooled<T>
+        acquire(Args &&...args)
+        {
+            size_t const live = T::admit_wait();
+            return construct_in<T>(T::pool().acquire(), live, std::forward<Args>(args)...);
+        }
+
+        // waits at most `timeout` for a free admission and slot
+        template <typename T, typename Rep, typename Period, typename... Args>
+        std::optional<pooled<T>>
+        acquire_for(std::chrono::duration<Rep, Period> const &timeout, Args &&...args)
+        {
+            auto const   deadline = std::chrono::steady_clock::now() + timeout;
+            size_t const live     = T::admit_until(deadline);
+            void        *slot     = live ? T::pool().acquire_for(deadline - std::chrono::steady_clock::now()) : nullptr;
+            if (not slot)
+            {
+                if (live)
+                {
+                    T::dismiss();
+                }
+                T::metrics().rejections.add();
+                return std::nullopt;
+            }
+            return construct_in<T>(slot, live, std::forward<Args>(args)...);
+        }
+    } // namespace
+
+    namespace
+    {
+        // Stress test: all threads construct T in a loop and record the live count while holding an instance.
+        // Returns the highest count observed, which must reach the limit but never exceed it. Holders yield, so
+        // instances overlap even on a single core.
+        template <typename T>
+        size_t
+        max_live_instances(unsigned threads, size_t iterations)
+        {
+            std::atomic<size_t> max_seen{0};
+            {
+                std::vector<std::jthread> workers;
+                for (unsigned t = 0; t < threads; ++t)
+                {
+                    workers.emplace_back([&] {
+                        for (size_t i = 0; i < iterations; ++i)
+                        {
+                            try
+                            {
+                                T      instance;
+                                size_t live = T::count.value.load();
+                                size_t seen = max_seen.load();
+                                while (live > seen && not max_seen.compare_exchange_weak(seen, live))
+                                {
+                                }
+                                std::this_thread::yield();
+                            }
+                            catch (std::logic_error const &)
+                            {
+                                // limit reached, try again
+                            }
+                        }
+                    });
+                }
+            }
+            return max_seen;
+        }
+
+        struct contention_result
+        {
+            size_t admitted    = 0;
+            size_t rejected    = 0;
+            double admitted_ns = 0; // per attempt
+            double rejected_ns = 0;
+        };
+
+        // Construct/destroy attempts of `threads` contending threads, timed per attempt once all threads are
+        // running. Rejections pay for the exception, so they are reported apart from admissions.
+        template <typename T>
+        contention_result
+        contention(unsigned threads, size_t iterations)
+        {
+            std::vector<contention_result> results(threads);
+            std::latch                     start{static_cast<std::ptrdiff_t>(threads)};
+            {
+                std::vector<std::jthread> workers;
+                for (unsigned t = 0; t < threads; ++t)
+                {
+                    workers.emplace_back([&, t] {
+                        contention_result &r = results[t];
+                        start.arrive_and_wait();
+                        for (size_t i = 0; i < iterations; ++i)
+                        {
+                            benchmarking::stopwatch watch;
+                            watch.start();
+                            try
+                            {
+                                T instance;
+                                ++r.admitted;
+                                r.admitted_ns += static_cast<double>(watch.stop());
+                            }
+                            catch (std::logic_error const &)
+                            {
+                                ++r.rejected;
+                                r.rejected_ns += static_cast<double>(watch.stop());
+                            }
+                        }
+                    });
+                }
+            }
+
+            contention_result total;
+            for (contention_result const &r : results)
+            {
+                total.admitted    += r.admitted;
+                total.rejected    += r.rejected;
+                total.admitted_ns += r.admitted_ns;
+                total.rejected_ns += r.rejected_ns;
+            }
+            total.admitted_ns /= static_cast<double>(std::max<size_t>(total.admitted, 1));
+            total.rejected_ns /= static_cast<double>(std::max<size_t>(total.rejected, 1));
+            return total;
+        }
+
+        // Acquire/release throughput and fairness of an acquire policy: `threads` threads hold an instance for a
+        // moment and release it, for `duration`. Fairness is the ratio of the least to the most successful thread.
+        template <typename Acquire>
+        void
+        policy_benchmark(std::string_view name, unsigned threads, std::chrono::milliseconds duration, Acquire acquire)
+        {
+            std::vector<size_t> successes(threads);
+            std::atomic<bool>   done{false};
+            {
+                std::vector<std::jthread> workers;
+                for (unsigned t = 0; t < threads; ++t)
+                {
+                    workers.emplace_back([&, t] {
+                        size_t n = 0;
+                        while (not done.load(std::memory_order_relaxed))
+                        {
+                            n += acquire(); // returns 1 if it got (and released) an instance
+                        }
+                        successes[t] = n;
+                    });
+                }
+                std::this_thread::sleep_for(duration);
+                done = true;
+            }
+
+            auto [least, most] = std::ranges::minmax(successes);
+            double total       = static_cast<double>(std::accumulate(successes.begin(), successes.end(), size_t{0}));
+            std::println("{:<12} {:>10.0f} ops/s, fairness {:.2f}", name,
+                         total / std::chrono::duration<double>(duration).count(),
+                         most ? static_cast<double>(least) / static_cast<double>(most) : 0.0);
+        }
+    } // namespace
+} // namespace limited_number
+
+namespace string_interning
+{
+    // Append-only, hash-consed string table: every distinct string is stored once in a chunked arena and
+    // identified by a 32-bit symbol. Lookups are lock-free; inserting a new string takes a mutex.
+
+    class symbol_table;
+
+    class symbol
+    {
+      public:
+        constexpr symbol() = default; // the empty string
+
+        std::uint32_t
+        id() const
+        {
+            return value;
+        }
+
+        std::string_view view() const; // text in the global table
+
+        friend bool
+        operator==(symbol, symbol) = default;
+
+        friend auto
+        operator<=>(symbol, symbol) = default;
+
+        friend std::ostream &
+        operator<<(std::ostream &os, symbol s)
+        {
+            return os << s.view();
+        }
+
+      private:
+        explicit constexpr symbol(std::uint32_t id) : value(id)
+        {
+        }
+
+        std::uint32_t value = 0;
+
+        friend class symbol_table;
+    };
+
+    // There is only the global table: a symbol is an id into it, and symbol::view() and printing look it up there.
+    class symbol_table
+    {
+      public:
+        symbol_table(symbol_table const &)            = delete;
+        symbol_table &operator=(symbol_table const &) = delete;
+
+        ~symbol_table()
+        {
+            for (auto &segment : segments)
+            {
+                delete[] segment.load(std::memory_order_relaxed);
+            }
+        }
+
+        static symbol_table &
+        global()
+        {
+            static symbol_table table;
+            return table;
+        }
+
+        // lock-free
+        std::optional<symbol>
+        find(std::string_view s) const
+        {
+            return find(s, std::hash<std::string_view>{}(s), *table.load(std::memory_order_acquire));
+        }
+
+        symbol
+        intern(std::string_view s)
+        {
+            std::size_t const h = std::hash<std::string_view>{}(s);
+            if (auto found = find(s, h, *table.load(std::memory_order_acquire)))
+            {
+                return *found;
+            }
+
+            std::lock_guard lock{mutex};
+            if (auto found = find(s, h, *table.load(std::memory_order_relaxed))) // interned by another thread
+            {
+                return *found;
+            }
+            if (count == std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::length_error{"symbol_table: out of symbol ids"};
+            }
+            if (2 * (count + 1) > table.load(std::memory_order_relaxed)->size())
+            {
+                grow();
+            }
+
+            std::uint32_t const id = count++;
+            set_entry(id, store(s));
+            insert(*table.load(std::memory_order_relaxed), h, id); // publishes the entry
+            return symbol{id};
+        }
+
+        // lock-free, s must come from this table
+        std::string_view
+        view(symbol s) const
+        {
+            return entry(s.value);
+        }
+
+        std::size_t
+        size() const
+        {
+            std::lock_guard lock{mutex};
+            return count;
+        }
+
+        // arena, id directory and hash slots (including the tables replaced by growing)
+        std::size_t
+        memory_bytes() const
+        {
+            std::lock_guard lock{mutex};
+            std::size_t     bytes = 0;
+            for (auto const &c : chunks)
+            {
+                bytes += c.size;
+            }
+            for (std::size_t s = 0; s < segments.size(); ++s)
+            {
+                bytes += segments[s].load(std::memory_order_relaxed) ? segment_size(s) * sizeof(std::string_view) : 0;
+            }
+            for (auto const &t : tables)
+            {
+                bytes += t->size() * sizeof(slot);
+            }
+            return bytes;
+        }
+
+      private:
+        symbol_table()
+        {
+            tables.push_back(std::make_unique<slots>(1024));
+            table.store(tables.back().get(), std::memory_order_relaxed);
+            intern(""); // id 0 == symbol{}
+        }
+
+        // a slot packs the upper 32 bits of the hash with id + 1 (0 = empty)
+        using slot  = std::atomic<std::uint64_t>;
+        using slots = std::vector<slot>;
+
+        static constexpr std::size_t chunk_bytes   = 64 * 1024;
+        static constexpr std::size_t first_segment = 1024; // segment s holds first_segment << s ids
+
+        struct chunk
+        {
+            std::unique_ptr<char[]> data;
+            std::size_t             size;
+        };
+
+        static std::size_t
+        segment_size(std::size_t s)
+        {
+            return first_segment << s;
+        }
+
+        // ids live in segments of doubling size, so published entries never move
+        static std::pair<std::size_t, std::size_t>
+        locate(std::uint32_t id)
+        {
+            std::size_t const i = id + first_segment;
+            std::size_t const s = static_cast<std::size_t>(std::bit_width(i) - std::bit_width(first_segment));
+            return {s, i - segment_size(s)};
+        }
+
+        std::string_view
+        entry(std::uint32_t id) const
+        {
+            auto [s, i] = locate(id);
+            return segments[s].load(std::memory_order_acquire)[i];
+        }
+
+        void
+        set_entry(std::uint32_t id, std::string_view text)
+        {
+            auto [s, i] = locate(id);
+
+            std::string_view *segment = segments[s].load(std::memory_order_relaxed);
+            if (not segment)
+            {
+                segment = new std::string_view[segment_size(s)];
+                segments[s].store(segment, std::memory_order_release);
+            }
+            segment[i] = text;
+        }
+
+        std::optional<symbol>
+        find(std::string_view s, std::size_t h, slots const &t) const
+        {
+            std::uint64_t const tag  = h >> 32 & 0xffff'ffffu;
+            std::size_t const   mask = t.size() - 1;
+            for (std::size_t i = h & mask;; i = (i + 1) & mask)
+            {
+                std::uint64_t const v = t[i].load(std::memory_order_acquire);
+                if (v == 0)
+                {
+                    return std::nullopt;
+                }
+                auto const id = static_cast<std::uint32_t>(v) - 1;
+                if (v >> 32 == tag && entry(id) == s)
+                {
+                    return symbol{id};
+                }
+            }
+        }
+
+        void
+        insert(slots &t, std::size_t h, std::uint32_t id)
+        {
+            std::size_t const mask = t.size() - 1;
+            std::size_t       i    = h & mask;
+            while (t[i].load(std::memory_order_relaxed) != 0)
+            {
+                i = (i + 1) & mask;
+            }
+            t[i].store((h >> 32 & 0xffff'ffffu) << 32 | (std::uint64_t{id} + 1), std::memory_order_release);
+        }
+
+        // readers may still probe the old table: it stays alive, and a miss there falls back to the locked path
+        void
+        grow()
+        {
+            auto bigger = std::make_unique<slots>(2 * table.load(std::memory_order_relaxed)->size());
+            for (std::uint32_t id = 0; id < count; ++id)
+            {
+                insert(*bigger, std::hash<std::string_view>{}(entry(id)), id);
+            }
+            table.store(bigger.get(), std::memory_order_release);
+            tables.push_back(std::move(bigger));
+        }
+
+        std::string_view
+        store(std::string_view s)
+        {
+            if (chunks.empty() || chunks.back().size - used < s.size())
+            {
+                std::size_t const size = std::max(chunk_bytes, s.size());
+                chunks.push_back({std::make_unique<char[]>(size), size});
+                used = 0;
+            }
+            char *at = chunks.back().data.get() + used;
+            std::ranges::copy(s, at);
+            used += s.size();
+            return {at, s.size()};
+        }
+
+        mutable std::mutex                              mutex;
+        std::vector<chunk>                              chunks;
+        std::size_t                                     used  = 0;
+        std::uint32_t                                   count = 0;
+        std::array<std::atomic<std::string_view *>, 32> segments{};
+        std::vector<std::unique_ptr<slots>>             tables;
+        std::atomic<slots *>                            table;
+    };
+
+    inline std::string_view
+    symbol::view() const
+    {
+        return symbol_table::global().view(*this);
+    }
+
+    inline symbol
+    intern(std::string_view s)
+    {
+        return symbol_table::global().intern(s);
+    }
+} // namespace string_interning
+
+namespace composite_pattern
+{
+    // Actually we make hero and hero_party both iterables so we can treat them the same and
+    // derive them from a common base class.
+    //
+    // hero       = iterable of exactly one element
+    // hero_party = iterable of multiple elements/heros (implemented as a std::vector)
+
+    template <typename T>
+    struct base
+    {
+        template <typename U>
+        void ally_with(U &other);
+
+        // same result as ally_with, for large parties: edges are collected, sorted and deduplicated in parallel,
+        // then merged into each hero's connections in one pass
+        template <typename U>
+        void ally_with_bulk(U &other, unsigned threads = std::max(1u, std::thread::hardware_concurrency()));
+    };
+
+    class alliance_graph;
+
+    struct hero : base<hero>
+    {
+        hero(std::string_view n) : name(string_interning::intern(n))
+        {
+        }
+
+        // making hero into an iterable (for-range-loop capable)
+        hero *
+        begin()
+        {
+            return this;
+        }
+
+        hero *
+        end()
+        {
+            return this + 1; // there is only one hero in a hero ;-)
+        }
+
+      private:
+        string_interning::symbol name; // 4 bytes instead of a std::string, compared as an integer
+        std::set<hero *>         connections;
+
+        template <typename U>
+        friend struct base;
+
+        template <typename U>
+        friend std::ostream &operator<<(std::ostream &os, base<U> &object);
+
+        friend class alliance_graph;
+    };
+
+    struct hero_party : std::vector<hero>, base<hero_party>
+    {
+    };
+
+    template <typename T>
+    template <typename U>
+    void
+    base<T>::ally_with(U &other)
+    {
+        for (hero &from : *static_cast<T *>(this)) // upcast base to hero or hero_party (this = base<T> *)
+        {
+            for (hero &to : other)                 // make connections to hero or heros
+            {
+                from.connections.insert(&to);
+                to.connections.insert(&from);
+            }
+        }
+    }
+
+    namespace detail
+    {
+        // sorts chunks in parallel, then merges neighbouring chunks pairwise (also in parallel)
+        template <typename It, typename Compare>
+        void
+        parallel_sort(It first, It last, Compare cmp, unsigned threads)
+        {
+            auto const n = static_cast<std::size_t>(last - first);
+            if (threads <= 1 || n < (1 << 16))
+            {
+                std::sort(first, last, cmp);
+                return;
+            }
+
+            std::vector<It> bounds;
+            for (unsigned t = 0; t <= threads; ++t)
+            {
+                bounds.push_back(first + static_cast<std::ptrdiff_t>(n * t / threads));
+            }
+
+            {
+                std::vector<std::jthread> workers;
+                for (unsigned t = 0; t < threads; ++t)
+                {
+                    workers.emplace_back([&, t] { std::sort(bounds[t], bounds[t + 1], cmp); });
+                }
+            }
+
+            for (std::size_t width = 1; width < threads; width *= 2)
+            {
+                std::vector<std::jthread> workers;
+                for (std::size_t t = 0; t + width < threads; t += 2 * width)
+                {
+                    auto const end = std::min<std::size_t>(t + 2 * width, threads);
+                    workers.emplace_back([&, t, width, end] {
+                        std::inplace_merge(bounds[t], bounds[t + width], bounds[end], cmp);
+                    });
+                }
+            }
+        }
+    } // namespace detail
+
+    template <typename T>
+    template <typename U>
+    void
+    base<T>::ally_with_bulk(U &other, unsigned threads)
+    {
+        threads = std::max(threads, 1u);
+
+        // 1. collect all edges (both directions) into one buffer
+        std::vector<std::pair<hero *, hero *>> edges;
+        for (hero &from : *static_cast<T *>(this))
+        {
+            for (hero &to : other)
+            {
+                edges.emplace_back(&from, &to);
+                edges.emplace_back(&to, &from);
+            }
+        }
+
+        // 2. sort by (from, to) and drop duplicates
+        auto by_hero = [](auto const &a, auto const &b) {
+            std::less<hero *> less; // total order, unlike `<` on unrelated pointers
+            return less(a.first, b.first) || (a.first == b.first && less(a.second, b.second));
+        };
+        detail::parallel_sort(edges.begin(), edges.end(), by_hero, threads);
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        // 3. every hero's edges form one sorted run; runs are merged into the heroes' sets in parallel
+        //    (each hero belongs to exactly one run, so no two threads touch the same set)
+        std::vector<std::size_t> runs;
+        for (std::size_t i = 0; i < edges.size(); ++i)
+        {
+            if (i == 0 || edges[i].first != edges[i - 1].first)
+            {
+                runs.push_back(i);
+            }
+        }
+        runs.push_back(edges.size());
+
+        auto merge_runs = [&](std::size_t first_run, std::size_t last_run) {
+            for (std::size_t r = first_run; r < last_run; ++r)
+            {
+                auto &connections = edges[runs[r]].first->connections;
+                for (std::size_t i = runs[r]; i < runs[r + 1]; ++i)
+                {
+                    connections.insert(connections.end(), edges[i].second); // sorted input: hint at the end
+                }
+            }
+        };
+
+        // small batches (like parallel_sort's) are merged inline: starting threads would cost more than the merge
+        std::size_t const run_count = runs.size() - 1;
+        if (threads == 1 || edges.size() < (1 << 16))
+        {
+            merge_runs(0, run_count);
+            return;
+        }
+
+        std::vector<std::jthread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back(merge_runs, run_count * t / threads, run_count * (t + 1) / threads);
+        }
+    }
+
+    // print base (hero or hero_party)
+    template <typename T>
+    std::ostream &
+    operator<<(std::ostream &os, base<T> &object)
+    {
+        for (hero &obj : *static_cast<T *>(&object)) // upcast object to hero or hero_party (content is both hero(s))
+        {
+            for (hero *c : obj.connections)          // print hero's connections
+            {
+                os << obj.name << " -> [" << c->name << "]" << '\n';
+            }
+        }
+        return os;
+    }
+
+    // Compressed sparse row (CSR) adjacency: the neighbours of vertex v are
+    // neighbours[offsets[v]] ... neighbours[offsets[v + 1] - 1], sorted and without duplicates.
+    // Edges are added in batches and merged into the CSR arrays by compact(). Iterating the neighbours of a
+    // vertex is a walk over contiguous memory (std::set allocates a tree node per edge and chases pointers).
+    class csr_graph
+    {
+      public:
+        using vertex = std::uint32_t;
+
+        void
+        add_edge(vertex from, vertex to)
+        {
+            pending.push_back(std::uint64_t{from} << 32 | to); // sorts by (from, to)
+            vertices = std::max({vertices, std::size_t{from} + 1, std::size_t{to} + 1});
+        }
+
+        // merges all pending edges into the CSR arrays
+        void
+        compact()
+        {
+            std::sort(pending.begin(), pending.end());
+            pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+
+            std::vector<std::uint32_t> new_offsets(vertices + 1);
+            std::vector<vertex>        new_neighbours;
+            new_neighbours.reserve(neighbours.size() + pending.size());
+
+            auto next = pending.begin();
+            for (std::size_t v = 0; v < vertices; ++v)
+            {
+                // union of the existing (sorted) neighbours and the pending (sorted) edges of v
+                auto existing = adjacent(static_cast<vertex>(v));
+                auto old      = existing.begin();
+                while (old != existing.end() || (next != pending.end() && (*next >> 32) == v))
+                {
+                    bool const has_new = next != pending.end() && (*next >> 32) == v;
+                    auto const fresh   = has_new ? static_cast<vertex>(*next) : vertex{};
+                    if (not has_new || (old != existing.end() && *old < fresh))
+                    {
+                        new_neighbours.push_back(*old++);
+                    }
+                    else
+                    {
+                        if (old != existing.end() && *old == fresh)
+                        {
+                            ++old;
+                        }
+                        new_neighbours.push_back(fresh);
+                        ++next;
+                    }
+                }
+                if (new_neighbours.size() > std::numeric_limits<std::uint32_t>::max())
+                {
+                    throw std::length_error{"csr_graph: more edges than 32-bit offsets can address"};
+                }
+                new_offsets[v + 1] = static_cast<std::uint32_t>(new_neighbours.size());
+            }
+
+            offsets    = std::move(new_offsets);
+            neighbours = std::move(new_neighbours);
+            pending    = {};
+        }
+
+        // neighbours of v (edges added since the last compact() are not included)
+        std::span<vertex const>
+        adjacent(vertex v) const
+        {
+            if (std::size_t{v} + 1 >= offsets.size())
+            {
+                return {};
+            }
+            return {neighbours.data() + offsets[v], neighbours.data() + offsets[v + 1]};
+        }
+
+        std::size_t
+        vertex_count() const
+        {
+            return vertices;
+        }
+
+        std::size_t
+        edge_count() const
+        {
+            return neighbours.size();
+        }
+
+        std::size_t
+        memory_bytes() const
+        {
+            return offsets.capacity() * sizeof(std::uint32_t) + neighbours.capacity() * sizeof(vertex);
+        }
+
+      private:
+        std::size_t                vertices = 0;
+        std::vector<std::uint32_t> offsets;
+        std::vector<vertex>        neighbours;
+        std::vector<std::uint64_t> pending; // (from << 32 | to) of edges not yet compacted
+    };
+
+    // Heroes and their alliances as a CSR graph. Works with heroes and hero_parties alike, like base::ally_with.
+    class alliance_graph
+    {
+      public:
+        using vertex = csr_graph::vertex;
+
+        // vertex of a hero (added on first use)
+        vertex
+        vertex_of(hero &h)
+        {
+            auto [it, inserted] = index.try_emplace(&h, static_cast<vertex>(heroes.size()));
+            if (inserted)
+            {
+                heroes.push_back(&h);
+            }
+            return it->second;
+        }
+
+        // adds edges in both directions between all heroes of `a` and `b` (compact() makes them visible); a hero
+        // is not its own ally, so ally(p, p) connects the members of p with each other only
+        template <typename T, typename U>
+        void
+        ally(T &a, U &b)
+        {
+            for (hero &from : a)
+            {
+                vertex f = vertex_of(from);
+                for (hero &to : b)
+                {
+                    vertex t = vertex_of(to);
+                    if (f != t)
+                    {
+                        graph.add_edge(f, t);
+                        graph.add_edge(t, f);
+                    }
+                }
+            }
+        }
+
+        // bulk build from the std::set connections of existing heroes
+        template <typename T>
+        void
+        import(T &heroes)
+        {
+            for_each_set_edge(heroes, [this](hero &from, hero &to) { graph.add_edge(vertex_of(from), vertex_of(to)); });
+        }
+
+        void
+        compact()
+        {
+            graph.compact();
+        }
+
+        std::span<vertex const>
+        allies(vertex v) const
+        {
+            return graph.adjacent(v);
+        }
+
+        std::string_view
+        name(vertex v) const
+        {
+            return heroes[v]->name.view();
+        }
+
+        std::size_t
+        hero_count() const
+        {
+            return heroes.size();
+        }
+
+        csr_graph const &
+        csr() const
+        {
+            return graph;
+        }
+
+        // calls f(from, to) for every std::set connection of the heroes in `heroes`
+        template <typename T, typename F>
+        static void
+        for_each_set_edge(T &heroes, F &&f)
+        {
+            for (hero &from : heroes)
+            {
+                for (hero *to : from.connections)
+                {
+                    f(from, *to);
+                }
+            }
+        }
+
+        friend std::ostream &
+        operator<<(std::ostream &os, alliance_graph const &g)
+        {
+            for (vertex v = 0; v < g.heroes.size(); ++v)
+            {
+                for (vertex a : g.allies(v))
+                {
+                    os << g.name(v) << " -> [" << g.name(a) << "]" << '\n';
+                }
+            }
+            return os;
+        }
+
+      private:
+        csr_graph                          graph;
+        std::vector<hero *>                heroes;
+        std::unordered_map<hero *, vertex> index;
+    };
+} // namespace composite_pattern
+
+namespace hero_arena
+{
+    // hero_party is a std::vector<hero> and connections are hero *, so growing a party after an alliance
+    // reallocates the vector and leaves dangling pointers. Here heroes live in an arena and are referred to by
+    // 32-bit handles (slot index + generation): the arena may reallocate freely, handles stay valid, and a
+    // handle to a destroyed hero is detected instead of dangling. Parties are runs of slot indices.
+
+    class handle
+    {
+      public:
+        static constexpr unsigned index_bits = 24; // up to 16M heroes, 256 generations per slot (then it is retired)
+
+        constexpr handle(std::uint32_t index, std::uint8_t generation)
+            : bits(index | std::uint32_t{generation} << index_bits)
+        {
+        }
+
+        constexpr std::uint32_t
+        index() const
+        {
+            return bits & ((1u << index_bits) - 1);
+        }
+
+        constexpr std::uint8_t
+        generation() const
+        {
+            return static_cast<std::uint8_t>(bits >> index_bits);
+        }
+
+        constexpr auto operator<=>(handle const &) const = default;
+
+        // a handle is an iterable of exactly one hero (like composite_pattern::hero)
+        handle const *
+        begin() const
+        {
+            return this;
+        }
+
+        handle const *
+        end() const
+        {
+            return this + 1;
+        }
+
+      private:
+        std::uint32_t bits;
+    };
+
+    static_assert(sizeof(handle) == sizeof(composite_pattern::hero *) / 2); // edges take half the memory
+
+    class arena
+    {
+      public:
+        static constexpr std::uint32_t no_party = 0;
+
+        handle
+        create(std::string_view name, std::uint32_t party = no_party)
+        {
+            std::uint32_t index;
+            if (not free_slots.empty())
+            {
+                index = free_slots.back();
+                free_slots.pop_back();
+            }
+            else
+            {
+                index = static_cast<std::uint32_t>(records.size());
+                if (index >= 1u << handle::index_bits)
+                {
+                    throw std::length_error{"hero arena is full"};
+                }
+                records.emplace_back();
+            }
+
+            record &r = records[index];
+            r.name    = string_interning::intern(name);
+            r.party   = party;
+            r.alive   = true;
+            return {index, r.generation};
+        }
+
+        // The slot is reused later with a new generation, so existing handles become stale. After its last
+        // generation the slot is retired instead: wrapping around would make old handles valid again.
+        void
+        destroy(handle h)
+        {
+            if (record *r = get(h))
+            {
+                for (handle ally : std::exchange(r->connections, {})) // moved out: erasing below never touches it
+                {
+                    if (record *other = get(ally))
+                    {
+                        std::erase(other->connections, h);
+                    }
+                }
+                r->name  = {};
+                r->alive = false;
+                if (r->generation != std::numeric_limits<std::uint8_t>::max())
+                {
+                    ++r->generation;
+                    free_slots.push_back(h.index());
+                }
+            }
+        }
+
+        bool
+        valid(handle h) const
+        {
+            return h.index() < records.size() && records[h.index()].alive &&
+                   records[h.index()].generation == h.generation();
+        }
+
+        std::string_view
+        name(handle h) const
+        {
+            return valid(h) ? records[h.index()].name.view() : std::string_view{};
+        }
+
+        std::span<handle const>
+        allies(handle h) const
+        {
+            return valid(h) ? std::span<handle const>{records[h.index()].connections} : std::span<handle const>{};
+        }
+
+        // current handle of a slot
+        handle
+        at(std::uint32_t index) const
+        {
+            return {index, records[index].generation};
+        }
+
+        // a freed slot may be reused by another party, so parties check membership when iterating
+        bool
+        member_of(std::uint32_t index, std::uint32_t party) const
+        {
+            return records[index].alive && records[index].party == party;
+        }
+
+        std::uint32_t
+        new_party_id()
+        {
+            return ++parties;
+        }
+
+        // composite: works with handles and parties alike (both are iterables of handles)
+        template <typename A, typename B>
+        void
+        ally(A const &a, B const &b)
+        {
+            for (handle from : a)
+            {
+                for (handle to : b)
+                {
+                    connect(from, to);
+                    connect(to, from);
+                }
+            }
+        }
+
+      private:
+        struct record
+        {
+            string_interning::symbol name;
+            std::vector<handle>      connections; // sorted
+            std::uint32_t            party      = no_party;
+            std::uint8_t             generation = 0;
+            bool                     alive      = false;
+        };
+
+        record *
+        get(handle h)
+        {
+            return valid(h) ? &records[h.index()] : nullptr;
+        }
+
+        // a hero is not its own ally: ally(p, p) connects the members of p with each other only
+        void
+        connect(handle from, handle to)
+        {
+            if (record *r = get(from); r && from != to && valid(to))
+            {
+                auto pos = std::lower_bound(r->connections.begin(), r->connections.end(), to);
+                if (pos == r->connections.end() || *pos != to)
+                {
+                    r->connections.insert(pos, to);
+                }
+            }
+        }
+
+        std::vector<record>        records; // may reallocate: nobody holds pointers into it
+        std::vector<std::uint32_t> free_slots;
+        std::uint32_t              parties = no_party;
+    };
+
+    // A party is a sorted list of index runs [first, last) into the arena; members are appended freely.
+    class party
+    {
+      public:
+        explicit party(arena &a) : home(&a), id(a.new_party_id())
+        {
+        }
+
+        handle
+        emplace_back(std::string_view name)
+        {
+            handle h = home->create(name, id);
+            cover(h.index());
+            return h;
+        }
+
+        class iterator
+        {
+          public:
+            using value_type      = handle;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            iterator(party const *p, std::size_t r, std::uint32_t i) : owner(p), run(r), index(i)
+            {
+                skip_non_members();
+            }
+
+            handle
+            operator*() const
+            {
+                return owner->home->at(index);
+            }
+
+            iterator &
+            operator++()
+            {
+                advance();
+                skip_non_members();
+                return *this;
+            }
+
+            iterator
+            operator++(int)
+            {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            bool
+            operator==(iterator const &other) const
+            {
+                return run == other.run && (run == owner->runs.size() || index == other.index);
+            }
+
+          private:
+            void
+            advance()
+            {
+                if (++index == owner->runs[run].second && ++run < owner->runs.size())
+                {
+                    index = owner->runs[run].first;
+                }
+            }
+
+            // destroyed heroes (and slots reused by other parties) are skipped
+            void
+            skip_non_members()
+            {
+                while (run < owner->runs.size() && not owner->home->member_of(index, owner->id))
+                {
+                    advance();
+                }
+            }
+
+            party const  *owner = nullptr;
+            std::size_t   run   = 0;
+            std::uint32_t index = 0;
+        };
+
+        iterator
+        begin() const
+        {
+            return runs.empty() ? end() : iterator{this, 0, runs.front().first};
+        }
+
+        iterator
+        end() const
+        {
+            return {this, runs.size(), 0};
+        }
+
+        friend std::ostream &
+        operator<<(std::ostream &os, party const &p)
+        {
+            for (handle h : p)
+            {
+                for (handle ally : p.home->allies(h))
+                {
+                    os << p.home->name(h) << " -> [" << p.home->name(ally) << "]" << '\n';
+                }
+            }
+            return os;
+        }
+
+      private:
+        // Runs are kept sorted and disjoint, so every slot is visited once. A slot freed by this party and reused
+        // for a new member is already covered; otherwise the index extends or joins its neighbouring runs.
+        void
+        cover(std::uint32_t index)
+        {
+            auto next = std::ranges::upper_bound(runs, index, {}, &std::pair<std::uint32_t, std::uint32_t>::first);
+            auto prev = next == runs.begin() ? runs.end() : std::prev(next);
+            if (prev != runs.end() && index < prev->second)
+            {
+                return;
+            }
+
+            bool const joins_prev = prev != runs.end() && prev->second == index;
+            bool const joins_next = next != runs.end() && next->first == index + 1;
+            if (joins_prev && joins_next)
+            {
+                prev->second = next->second;
+                runs.erase(next);
+            }
+            else if (joins_prev)
+            {
+                ++prev->second;
+            }
+            else if (joins_next)
+            {
+                --next->first;
+            }
+            else
+            {
+                runs.emplace(next, index, index + 1);
+            }
+        }
+
+        arena                                                *home;
+        std::uint32_t                                         id;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> runs; // [first, last), sorted by first
+    };
+
+    static_assert(std::forward_iterator<party::iterator>);
+} // namespace hero_arena
+
+namespace alliance_analytics
 {
-    template <typename... T>
-    void
-    print1(T... args)
+    // Graph algorithms over the CSR alliance graph (composite_pattern::csr_graph). Alliances are symmetric
+    // (ally_with adds both directions), so a vertex's neighbours are both its out- and in-edges.
+
+    using composite_pattern::csr_graph;
+    using vertex = csr_graph::vertex;
+
+    constexpr std::uint32_t unreached = std::numeric_limits<std::uint32_t>::max();
+
+    struct bfs_result
     {
-        (..., (std::cout << args)) << '\n'; // comma operator
+        std::vector<std::uint32_t> depth;  // hops from the source, `unreached` if not connected
+        std::vector<vertex>        parent; // previous vertex on a shortest path
+    };
+
+    // Direction-optimizing BFS (Beamer et al.): expand the frontier top-down while it is small, switch to
+    // bottom-up (every unvisited vertex looks for a parent in the frontier) when the frontier's edges outnumber
+    // the unexplored edges / alpha, and back when the frontier shrinks below n / beta.
+    // `max_depth` stops the search after that many hops.
+    inline bfs_result
+    bfs(csr_graph const &g, vertex source, std::uint32_t max_depth = unreached, bool direction_optimizing = true)
+    {
+        constexpr std::size_t alpha = 14;
+        constexpr std::size_t beta  = 24;
+
+        std::size_t const n = g.vertex_count();
+        bfs_result        r{std::vector<std::uint32_t>(n, unreached), std::vector<vertex>(n, source)};
+        if (source >= n)
+        {
+            return r;
+        }
+
+        std::vector<vertex> frontier{source};
+        std::vector<vertex> next;
+        std::vector<bool>   in_frontier(n);
+        r.depth[source] = 0;
+
+        std::size_t unexplored_edges = g.edge_count();
+        bool        bottom_up        = false;
+
+        for (std::uint32_t depth = 1; not frontier.empty() && depth <= max_depth; ++depth)
+        {
+            std::size_t frontier_edges = 0;
+            for (vertex v : frontier)
+            {
+                frontier_edges += g.adjacent(v).size();
+            }
+            unexplored_edges -= std::min(unexplored_edges, frontier_edges);
+
+            if (direction_optimizing)
+            {
+                if (not bottom_up && frontier_edges > unexplored_edges / alpha)
+                {
+                    bottom_up = true;
+                }
+                else if (bottom_up && frontier.size() < n / beta)
+                {
+                    bottom_up = false;
+                }
+            }
+
+            next.clear();
+            if (bottom_up)
+            {
+                std::fill(in_frontier.begin(), in_frontier.end(), false);
+                for (vertex v : frontier)
+                {
+                    in_frontier[v] = true;
+                }
+                for (vertex v = 0; v < n; ++v) // one sequential pass over the CSR arrays
+                {
+                    if (r.depth[v] != unreached)
+                    {
+                        continue;
+                    }
+                    for (vertex u : g.adjacent(v))
+                    {
+                        if (in_frontier[u])
+                        {
+                            r.depth[v]  = depth;
+                            r.parent[v] = u;
+                            next.push_back(v);
+                            break; // one parent is enough: skips the rest of v's edges
+                        }
+                    }
+                }
+            }
+            else
+            {
+                for (vertex u : frontier)
+                {
+                    for (vertex v : g.adjacent(u))
+                    {
+                        if (r.depth[v] == unreached)
+                        {
+                            r.depth[v]  = depth;
+                            r.parent[v] = u;
+                            next.push_back(v);
+                        }
+                    }
+                }
+            }
+            std::swap(frontier, next);
+        }
+        return r;
     }
 
-    template <typename... T>
-    void
-    print2(T... args)
+    // vertices on a shortest path from `from` to `to` (empty if not connected)
+    inline std::vector<vertex>
+    shortest_path(csr_graph const &g, vertex from, vertex to)
     {
-        (std::cout << ... << args) << '\n'; // binary left fold (init expression = std::cout)
+        bfs_result const r = bfs(g, from);
+        if (to >= r.depth.size() || r.depth[to] == unreached)
+        {
+            return {};
+        }
+
+        std::vector<vertex> path{to};
+        while (path.back() != from)
+        {
+            path.push_back(r.parent[path.back()]);
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
     }
 
-    template <typename T, typename... Args>
-    void
-    push_back_many(std::vector<T> &v, Args &&...args)
+    // all vertices at most k hops away from v (including v)
+    inline std::vector<vertex>
+    k_hop(csr_graph const &g, vertex v, std::uint32_t k)
     {
-        (..., v.push_back(args));
+        bfs_result const    r = bfs(g, v, k);
+        std::vector<vertex> result;
+        for (vertex u = 0; u < r.depth.size(); ++u)
+        {
+            if (r.depth[u] != unreached)
+            {
+                result.push_back(u);
+            }
+        }
+        return result;
     }
-} // namespace fold_expressions
 
-namespace factorial_class_template
+    // Connected components with a concurrent union-find: threads process disjoint vertex ranges, union by index
+    // (the larger root is linked below the smaller one with a CAS) and path halving in find.
+    // Returns the component label (smallest vertex of the component) for every vertex.
+    inline std::vector<vertex>
+    connected_components(csr_graph const &g, unsigned threads = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        std::size_t const                n = g.vertex_count();
+        std::vector<std::atomic<vertex>> parent(n);
+        for (vertex v = 0; v < n; ++v)
+        {
+            parent[v].store(v, std::memory_order_relaxed);
+        }
+
+        auto find = [&parent](vertex v) {
+            while (true)
+            {
+                vertex p  = parent[v].load(std::memory_order_relaxed);
+                vertex gp = parent[p].load(std::memory_order_relaxed);
+                if (p == gp)
+                {
+                    return p;
+                }
+                parent[v].compare_exchange_weak(p, gp, std::memory_order_relaxed); // path halving
+                v = gp;
+            }
+        };
+
+        auto unite = [&](vertex a, vertex b) {
+            while (true)
+            {
+                a = find(a);
+                b = find(b);
+                if (a == b)
+                {
+                    return;
+                }
+                if (a < b)
+                {
+                    std::swap(a, b);
+                }
+                vertex expected = a; // link the larger root below the smaller one, if it is still a root
+                if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                {
+                    return;
+                }
+            }
+        };
+
+        {
+            std::vector<std::jthread> workers;
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&, t] {
+                    for (std::size_t v = n * t / threads; v < n * (t + 1) / threads; ++v)
+                    {
+                        for (vertex u : g.adjacent(static_cast<vertex>(v)))
+                        {
+                            if (u < v) // every undirected edge once
+                            {
+                                unite(static_cast<vertex>(v), u);
+                            }
+                        }
+                    }
+                });
+            }
+        }
+
+        std::vector<vertex> label(n);
+        for (vertex v = 0; v < n; ++v)
+        {
+            label[v] = find(v);
+        }
+        return label;
+    }
+
+    // synthetic power-law graph (R-MAT): 2^scale vertices, edge_factor * 2^scale undirected edges
+    inline csr_graph
+    rmat(unsigned scale, std::size_t edge_factor, std::uint64_t seed = 42)
+    {
+        std::mt19937_64                        rng{seed};
+        std::uniform_real_distribution<double> coin{0.0, 1.0};
+        csr_graph                              g;
+
+        for (std::size_t e = 0; e < (edge_factor << scale); ++e)
+        {
+            vertex from = 0;
+            vertex to   = 0;
+            for (unsigned bit = 0; bit < scale; ++bit) // pick a quadrant: a = 0.57, b = 0.19, c = 0.19, d = 0.05
+            {
+                double const p = coin(rng);
+                from           = from << 1 | (p >= 0.76 ? 1u : 0u);
+                to             = to << 1 | ((p >= 0.57 && p < 0.76) || p >= 0.95 ? 1u : 0u);
+            }
+            if (from != to)
+            {
+                g.add_edge(from, to);
+                g.add_edge(to, from);
+            }
+        }
+        g.compact();
+        return g;
+    }
+} // namespace alliance_analytics
+
+namespace alliance_snapshot
 {
-    // class template (with static is )
+    // Binary snapshot of an alliance graph: hero names and CSR adjacency in one flat file. The layout holds
+    // offsets instead of pointers, so a read-only mmap of the file is used in place, with nothing to deserialise.
+    //
+    //   header | name offsets (u64, heroes + 1) | names (chars) | edge offsets (u64, heroes + 1) | allies (u32)
+    //
+    // Every section starts on an 8-byte boundary; all offsets are relative to the start of the file.
 
-    template <unsigned int N>
-    struct factorial
+    using composite_pattern::alliance_graph;
+    using composite_pattern::csr_graph;
+    using vertex = csr_graph::vertex;
+
+    struct header
     {
-        static constexpr unsigned int value = N * factorial<N - 1>::value;
+        std::array<char, 8> magic        = {'A', 'L', 'L', 'I', 'A', 'N', 'C', 'E'};
+        std::uint32_t       version      = 1;
+        std::uint32_t       heroes       = 0;
+        std::uint64_t       edges        = 0;
+        std::uint64_t       name_offsets = 0; // section positions
+        std::uint64_t       names        = 0;
+        std::uint64_t       edge_offsets = 0;
+        std::uint64_t       allies       = 0;
+        std::uint64_t       size         = 0; // of the whole file
     };
 
-    template <>
-    struct factorial<0>
+    inline std::uint64_t
+    align8(std::uint64_t n)
     {
-        static constexpr unsigned int value = 1;
-    };
+        return (n + 7) & ~std::uint64_t{7};
+    }
 
-    // API
-    template <unsigned int N>
-    constexpr unsigned int factorial_v = factorial<N>::value;
-} // namespace factorial_class_template
+    inline void
+    save(alliance_graph const &g, std::filesystem::path const &path)
+    {
+        header h;
+        h.heroes = static_cast<std::uint32_t>(g.hero_count());
+        h.edges  = g.csr().edge_count();
+
+        std::uint64_t names_bytes = 0;
+        for (vertex v = 0; v < h.heroes; ++v)
+        {
+            names_bytes += g.name(v).size();
+        }
+        h.name_offsets = align8(sizeof(header));
+        h.names        = h.name_offsets + (h.heroes + 1) * sizeof(std::uint64_t);
+        h.edge_offsets = align8(h.names + names_bytes);
+        h.allies       = h.edge_offsets + (h.heroes + 1) * sizeof(std::uint64_t);
+        h.size         = h.allies + h.edges * sizeof(vertex);
+
+        std::vector<char> image(h.size); // built in memory, written with one call
+        auto put = [&image](std::uint64_t at, auto const &value) {
+            std::memcpy(image.data() + at, &value, sizeof(value));
+        };
+        put(0, h);
+
+        std::uint64_t name_at = 0;
+        std::uint64_t edge_at = 0;
+        for (vertex v = 0; v < h.heroes; ++v)
+        {
+            put(h.name_offsets + v * sizeof(std::uint64_t), name_at);
+            put(h.edge_offsets + v * sizeof(std::uint64_t), edge_at);
+
+            std::string_view const name = g.name(v);
+            std::ranges::copy(name, image.data() + h.names + name_at);
+            name_at += name.size();
+
+            std::span<vertex const> const allies = g.allies(v);
+            std::memcpy(image.data() + h.allies + edge_at * sizeof(vertex), allies.data(), allies.size_bytes());
+            edge_at += allies.size();
+        }
+        put(h.name_offsets + h.heroes * sizeof(std::uint64_t), name_at);
+        put(h.edge_offsets + h.heroes * sizeof(std::uint64_t), edge_at);
+
+        // Written next to `path` and renamed over it: a snapshot still mapping the old file keeps its inode
+        // instead of having the file truncated and rewritten under it (SIGBUS or torn reads).
+        std::filesystem::path tmp = path;
+        tmp += ".tmp";
+        int const fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw std::system_error{errno, std::generic_category(), "open " + tmp.string()};
+        }
+        auto fail = [fd, &tmp](char const *what) {
+            int const error = errno;
+            ::close(fd);
+            ::unlink(tmp.c_str());
+            throw std::system_error{error, std::generic_category(), what + (" " + tmp.string())};
+        };
+        for (std::size_t done = 0; done < image.size();)
+        {
+            ssize_t const n = ::write(fd, image.data() + done, image.size() - done);
+            if (n < 0)
+            {
+                fail("write");
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        if (::fsync(fd) < 0)
+        {
+            fail("fsync");
+        }
+        ::close(fd);
+        if (::rename(tmp.c_str(), path.c_str()) < 0)
+        {
+            int const error = errno;
+            ::unlink(tmp.c_str());
+            throw std::system_error{error, std::generic_category(), "rename " + tmp.string()};
+        }
+    }
+
+    // read-only, private mapping of a whole file
+    class mapped_file
+    {
+      public:
+        explicit mapped_file(std::filesystem::path const &path)
+        {
+            int const fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw std::system_error{errno, std::generic_category(), "open " + path.string()};
+            }
+            struct stat st
+            {
+            };
+            if (::fstat(fd, &st) < 0)
+            {
+                int const error = errno;
+                ::close(fd);
+                throw std::system_error{error, std::generic_category(), "stat " + path.string()};
+            }
+            size = static_cast<std::size_t>(st.st_size);
+            data = size ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+            ::close(fd); // the mapping keeps the file alive
+            if (data == MAP_FAILED)
+            {
+                throw std::system_error{errno, std::generic_category(), "mmap " + path.string()};
+            }
+        }
 
-namespace factorial_variable_template
-{
-    // variable template (just syntactic sugar for class template with static member)
+        mapped_file(mapped_file &&other) noexcept
+            : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0))
+        {
+        }
 
-    template <unsigned int N>
-    constexpr unsigned int factorial = N * factorial<N - 1>;
+        mapped_file &operator=(mapped_file &&) = delete;
 
-    template <>
-    constexpr unsigned int factorial<0> = 1;
-} // namespace factorial_variable_template
+        ~mapped_file()
+        {
+            if (data)
+            {
+                ::munmap(data, size);
+            }
+        }
 
-namespace factorial_function_template
-{
-    // function template
+        std::span<char const>
+        bytes() const
+        {
+            return {static_cast<char const *>(data), size};
+        }
 
-    template <unsigned int n>
-    constexpr unsigned int
-    factorial()
-    {
-        return n * factorial<n - 1>();
-    }
+      private:
+        void       *data = nullptr;
+        std::size_t size = 0;
+    };
 
-    template <>
-    constexpr unsigned int
-    factorial<0>()
+    // the graph stored in a snapshot image, read in place
+    class view
     {
-        return 1;
-    }
-} // namespace factorial_function_template
+      public:
+        view() = default;
 
-namespace factorial_constexpr
-{
-    constexpr unsigned int
-    factorial(unsigned int const n)
-    {
-        return n > 1 ? n * factorial(n - 1) : 1;
-    }
-} // namespace factorial_constexpr
+        explicit view(std::span<char const> image) : base(image.data())
+        {
+            if (image.size() < sizeof(header))
+            {
+                throw std::runtime_error{"alliance snapshot: truncated header"};
+            }
+            std::memcpy(&h, base, sizeof(header));
+
+            // every section lies inside the image and is aligned; checked without products that could overflow
+            std::uint64_t const size    = image.size();
+            std::uint64_t const entries = std::uint64_t{h.heroes} + 1;
+            auto fits = [size](std::uint64_t at, std::uint64_t count, std::uint64_t width) {
+                return at % width == 0 && at <= size && count <= (size - at) / width;
+            };
+            if (h.magic != header{}.magic || h.version != header{}.version || h.size != size ||
+                not fits(h.name_offsets, entries, sizeof(std::uint64_t)) || h.names > size ||
+                not fits(h.edge_offsets, entries, sizeof(std::uint64_t)) || not fits(h.allies, h.edges, sizeof(vertex)))
+            {
+                throw std::runtime_error{"alliance snapshot: not a snapshot or wrong version"};
+            }
 
-namespace enable_if_template
-{
-    // widget (uses write())
+            // name() and allies() index the offset tables and the allies without checks, so validate them once
+            if (not ordered(section<std::uint64_t>(h.name_offsets), entries, size - h.names) ||
+                not ordered(section<std::uint64_t>(h.edge_offsets), entries, h.edges) ||
+                std::ranges::any_of(std::span{section<vertex>(h.allies), h.edges},
+                                    [this](vertex a) { return a >= h.heroes; }))
+            {
+                throw std::runtime_error{"alliance snapshot: corrupt offset table or ally"};
+            }
+        }
 
-    struct widget
-    {
-        int         id;
-        std::string name;
+        std::size_t
+        hero_count() const
+        {
+            return h.heroes;
+        }
 
-        std::ostream &
-        write(std::ostream &os) const
+        std::size_t
+        edge_count() const
         {
-            os << id << ',' << name << '\n';
-            return os;
+            return h.edges;
         }
-    };
 
-    // gadget (uses ostream)
+        std::string_view
+        name(vertex v) const
+        {
+            auto const *at = section<std::uint64_t>(h.name_offsets);
+            return {base + h.names + at[v], at[v + 1] - at[v]};
+        }
 
-    struct gadget
-    {
-        int         id;
-        std::string name;
+        std::span<vertex const>
+        allies(vertex v) const
+        {
+            auto const *at = section<std::uint64_t>(h.edge_offsets);
+            return {section<vertex>(h.allies) + at[v], section<vertex>(h.allies) + at[v + 1]};
+        }
 
-        friend std::ostream &operator<<(std::ostream &, gadget const &);
+      private:
+        // offsets[0] <= ... <= offsets[n - 1] <= limit
+        static bool
+        ordered(std::uint64_t const *offsets, std::uint64_t n, std::uint64_t limit)
+        {
+            return std::is_sorted(offsets, offsets + n) && offsets[n - 1] <= limit;
+        }
+
+        template <typename T>
+        T const *
+        section(std::uint64_t at) const
+        {
+            return reinterpret_cast<T const *>(base + at); // sections are aligned in the file, mmap is page aligned
+        }
+
+        char const *base = nullptr;
+        header      h;
     };
 
-    std::ostream &
-    operator<<(std::ostream &os, gadget const &g)
+    // A mapped snapshot plus an overlay for changes made after loading. The file is never written: new heroes
+    // and alliances live in the overlay and are visited after the snapshot's allies.
+    class snapshot
     {
-        os << g.id << ',' << g.name << '\n';
-        return os;
-    }
+      public:
+        explicit snapshot(std::filesystem::path const &path) : file(path), base(file.bytes())
+        {
+        }
 
-    // uses_write
-    // TODO: Should be part of widget, gadget (but this is about enable_if so we don't care).
-    // TODO: Class template with static member is a variable template.
+        std::size_t
+        hero_count() const
+        {
+            return base.hero_count() + added.size();
+        }
 
-    template <typename T>
-    struct uses_write
-    {
-        static constexpr bool value = false;
-    };
+        std::string_view
+        name(vertex v) const
+        {
+            return v < base.hero_count() ? base.name(v) : added[v - base.hero_count()].view();
+        }
 
-    template <>
-    struct uses_write<widget>
-    {
-        static constexpr bool value = true;
-    };
+        vertex
+        add_hero(std::string_view name)
+        {
+            added.push_back(string_interning::intern(name));
+            return static_cast<vertex>(hero_count() - 1);
+        }
 
-    template <typename T>
-    constexpr bool uses_write_v = uses_write<T>::value;
+        // both directions, visible after compact(); alliances already in the snapshot are skipped
+        void
+        ally(vertex a, vertex b)
+        {
+            if (a >= hero_count() || b >= hero_count())
+            {
+                throw std::out_of_range{"alliance snapshot: no such hero"};
+            }
+            if (not in_base(a, b))
+            {
+                overlay.add_edge(a, b);
+                overlay.add_edge(b, a);
+            }
+        }
 
-    // enable_if
+        void
+        compact()
+        {
+            overlay.compact();
+        }
 
-    template <bool B, typename T = void>
-    struct enable_if
-    {
-    };
+        template <typename F>
+        void
+        for_each_ally(vertex v, F &&f) const
+        {
+            if (v < base.hero_count())
+            {
+                for (vertex a : base.allies(v))
+                {
+                    f(a);
+                }
+            }
+            for (vertex a : overlay.adjacent(v))
+            {
+                f(a);
+            }
+        }
 
-    // only for true we have a `type`
-    template <typename T>
-    struct enable_if<true, T>
-    {
-        using type = T;
+        std::size_t
+        edge_count() const
+        {
+            return base.edge_count() + overlay.edge_count();
+        }
+
+        friend std::ostream &
+        operator<<(std::ostream &os, snapshot const &s)
+        {
+            for (vertex v = 0; v < s.hero_count(); ++v)
+            {
+                s.for_each_ally(v, [&](vertex a) { os << s.name(v) << " -> [" << s.name(a) << "]" << '\n'; });
+            }
+            return os;
+        }
+
+      private:
+        bool
+        in_base(vertex a, vertex b) const
+        {
+            return a < base.hero_count() && b < base.hero_count() && std::ranges::binary_search(base.allies(a), b);
+        }
+
+        mapped_file                           file;
+        view                                  base;
+        std::vector<string_interning::symbol> added; // heroes hero_count() of the snapshot and up
+        csr_graph                             overlay;
     };
+} // namespace alliance_snapshot
 
-    template <bool B, typename T = void>
-    using enable_if_t = enable_if<B, T>::type;
+namespace alliance_export
+{
+    // Dumps an alliance graph without going through iostream per edge: edges are formatted into large buffers
+    // (in parallel per range of heroes if asked) and the buffers are written in order with few write calls.
 
-    // serialize
+    using composite_pattern::alliance_graph;
+    using vertex = alliance_graph::vertex;
 
-    template <typename T, enable_if_t<uses_write_v<T>> * = nullptr>
-    void
-    serialize(std::ostream &os, T const &value)
+    inline void
+    write_all(int fd, std::string_view bytes)
     {
-        value.write(os);
+        while (not bytes.empty())
+        {
+            ssize_t const n = ::write(fd, bytes.data(), bytes.size());
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::system_error{errno, std::generic_category(), "write"};
+            }
+            bytes.remove_prefix(static_cast<std::size_t>(n));
+        }
     }
 
-    template <typename T, enable_if_t<not uses_write_v<T>> * = nullptr>
-    void
-    serialize(std::ostream &os, T const &value)
+    // same text as operator<<(std::ostream &, alliance_graph const &), for heroes [first, last)
+    inline void
+    format_text(alliance_graph const &g, vertex first, vertex last, std::string &out)
     {
-        os << value;
+        for (vertex v = first; v < last; ++v)
+        {
+            std::string_view const from = g.name(v);
+            for (vertex a : g.allies(v))
+            {
+                std::string_view const to = g.name(a);
+                out.append(from).append(" -> [").append(to).append("]\n");
+            }
+        }
     }
-} // namespace enable_if_template
-
-namespace sfinae_error
-{
-    // char (*)[N % 2 == 0] either creates char (*)[true] = char(*)[1] or char (*)[false] = char(*)[0].
-    // The latter - array of size 0 - is a SFINAE error.
-    // See https://en.cppreference.com/w/cpp/language/sfinae (lists type errors that are SFINAE errors)
 
-    template <typename T, size_t N>
-    void
-    handle(T (&)[N], char (*)[N % 2 == 0] = nullptr) // accepts array with even number of elements
+    // Heroes are cut into blocks of about `block_edges` edges. Each round formats `threads` blocks in parallel
+    // and writes them in hero order, so memory stays at threads blocks however large the graph is.
+    inline void
+    write_text(alliance_graph const &g, int fd, unsigned threads = 1, std::size_t block_edges = 1 << 16)
     {
-        std::println("handle even array: {} elements", N);
+        std::vector<vertex> bounds{0};
+        std::size_t         edges = 0;
+        for (vertex v = 0; v < g.hero_count(); ++v)
+        {
+            edges += g.allies(v).size();
+            if (edges >= block_edges)
+            {
+                bounds.push_back(v + 1);
+                edges = 0;
+            }
+        }
+        if (bounds.back() != g.hero_count())
+        {
+            bounds.push_back(static_cast<vertex>(g.hero_count()));
+        }
+
+        threads = std::max(1u, threads);
+        std::vector<std::string> buffers(threads);
+        for (std::size_t round = 0; round + 1 < bounds.size(); round += threads)
+        {
+            std::size_t const blocks = std::min<std::size_t>(threads, bounds.size() - 1 - round);
+            auto format = [&](std::size_t b) {
+                buffers[b].clear(); // keeps the capacity of earlier rounds
+                format_text(g, bounds[round + b], bounds[round + b + 1], buffers[b]);
+            };
+
+            if (blocks == 1)
+            {
+                format(0);
+            }
+            else
+            {
+                std::vector<std::jthread> workers;
+                for (std::size_t b = 0; b < blocks; ++b)
+                {
+                    workers.emplace_back(format, b);
+                }
+            }
+
+            for (std::size_t b = 0; b < blocks; ++b) // ordered merge
+            {
+                write_all(fd, buffers[b]);
+            }
+        }
     }
 
-    template <typename T, size_t N>
-    void
-    handle(T (&)[N], char (*)[N % 2 == 1] = nullptr) // accepts array with odd number of elements
+    // Binary edge list: header, then one (from, to) pair of native-endian 32-bit vertices per edge in CSR order.
+    // Names are not included (see alliance_snapshot for a self-contained format).
+    struct edge_list_header
     {
-        std::println("handle odd  array: {} elements", N);
+        std::array<char, 8> magic  = {'E', 'D', 'G', 'E', 'L', 'I', 'S', 'T'};
+        std::uint32_t       heroes = 0;
+        std::uint32_t       unused = 0;
+        std::uint64_t       edges  = 0;
+    };
+
+    inline void
+    write_binary(alliance_graph const &g, int fd, std::size_t buffer_bytes = 1 << 20)
+    {
+        edge_list_header const h{.heroes = static_cast<std::uint32_t>(g.hero_count()), .edges = g.csr().edge_count()};
+
+        std::string buffer;
+        buffer.reserve(buffer_bytes);
+        buffer.append(reinterpret_cast<char const *>(&h), sizeof(h));
+        for (vertex v = 0; v < g.hero_count(); ++v)
+        {
+            for (vertex a : g.allies(v))
+            {
+                std::array<vertex, 2> const edge{v, a};
+                buffer.append(reinterpret_cast<char const *>(edge.data()), sizeof(edge));
+                if (buffer.size() + sizeof(edge) > buffer_bytes)
+                {
+                    write_all(fd, buffer);
+                    buffer.clear();
+                }
+            }
+        }
+        write_all(fd, buffer);
     }
-} // namespace sfinae_error
+} // namespace alliance_export
 
-namespace decltype_templates
+namespace enable_shared_from_this_crtp
 {
-    namespace
+    // Helper type std::enabled_shared_from_this enables objects
+    // managed by a std::shared_ptr to generate more std::shared_ptr
+    // instances in a safe manner.
+
+    // The std::enable_shared_from_this class helps us create more shared_ptr
+    // objects from an existing one in a safe manner.
+    struct building : std::enable_shared_from_this<building>
     {
-        template <typename T>
-        struct foo
-        {
-            using foo_type = T;
-        };
+        // ...
+    };
+} // namespace enable_shared_from_this_crtp
 
-        template <typename T>
-        struct bar
-        {
-            using bar_type = T;
-        };
+namespace intrusive_ref_counting
+{
+    // CRTP alternative to std::enable_shared_from_this: the reference count lives inside the object, so there is
+    // no control block, from_this() is a plain increment, and single-threaded code can opt out of atomics.
 
-        template <typename T>
-        struct dummy
+    struct atomic_count
+    {
+        void
+        increment() noexcept
         {
-            using dummy_type = T;
-        };
-    } // namespace
+            value.fetch_add(1, std::memory_order_relaxed);
+        }
 
-    namespace
-    {
-        template <typename T>
-        decltype(typename T::foo_type(), void()) // NOTE: comma operator
-        handle(T const &)
+        // returns the new count; acquire/release so the last owner sees all writes before deleting
+        std::uint32_t
+        decrement() noexcept
         {
-            std::println("handle a foo");
+            return value.fetch_sub(1, std::memory_order_acq_rel) - 1;
         }
 
-        template <typename T>
-        decltype(typename T::bar_type(), void()) // NOTE: comma operator
-        handle(T const &)
+        std::uint32_t
+        load() const noexcept
         {
-            std::println("handle a bar");
+            return value.load(std::memory_order_relaxed);
         }
-    } // namespace
-} // namespace decltype_templates
 
-namespace common_type
-{
-    namespace
+        std::atomic<std::uint32_t> value{0};
+    };
+
+    // for objects that never cross threads
+    struct plain_count
     {
-        template <typename, typename... Ts>
-        struct has_common_type : std::false_type
+        void
+        increment() noexcept
         {
-        };
+            ++value;
+        }
 
-        template <typename... Ts>
-        struct has_common_type<std::void_t<std::common_type_t<Ts...>>, Ts...> : std::true_type
+        std::uint32_t
+        decrement() noexcept
         {
-        };
+            return --value;
+        }
 
-        template <typename... Ts>
-        constexpr bool has_common_type_v = sizeof...(Ts) < 2 || has_common_type<void, Ts...>::value;
-    } // namespace
+        std::uint32_t
+        load() const noexcept
+        {
+            return value;
+        }
 
-    template <typename... Ts, typename = std::enable_if_t<has_common_type_v<Ts...>>>
-    void
-    process(Ts &&...)
-    {
-        std::println("{}", demangle(typeid(std::common_type_t<Ts...>).name()));
-    }
-} // namespace common_type
+        std::uint32_t value = 0;
+    };
 
-namespace constraints_concepts
-{
-    // A CONSTRAINT is a modern way to define requirements on template parameters.
-    // A CONSTRAINT is a predicate that evaluates to true or false at compile-time.
-    // A CONCEPT is a set of named constraints
+    template <typename T>
+    class intrusive_ptr;
 
-    namespace no_check
+    // The last owner deletes the object as a Derived, so Derived must be final or have a virtual destructor, and
+    // every object must come from make_intrusive(): from_this() on a stack or member object would delete it.
+    // Derived types make that hard to get wrong with a private constructor and make_intrusive as a friend.
+    template <typename Derived, typename Policy = atomic_count>
+    class intrusive_ref
     {
-        template <typename T>
-        T
-        add(T const a, T const b)
+      public:
+        intrusive_ptr<Derived>
+        from_this()
         {
-            return a + b;
+            return intrusive_ptr<Derived>{static_cast<Derived *>(this)};
         }
-    } // namespace no_check
 
-    namespace enable_if_check
-    {
-        template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
-        T
-        add(T const a, T const b)
+        intrusive_ptr<Derived const>
+        from_this() const
         {
-            return a + b;
+            return intrusive_ptr<Derived const>{static_cast<Derived const *>(this)};
         }
-    } // namespace enable_if_check
 
-    namespace static_assert_check
-    {
-        template <typename T>
-        T
-        add(T const a, T const b)
+        std::uint32_t
+        use_count() const noexcept
         {
-            static_assert(std::is_arithmetic_v<T>, "Arithmetic type required");
-            return a + b;
+            return count.load();
         }
-    } // namespace static_assert_check
 
-    namespace requires_check
-    {
-        // REQUIRES CLAUSE doesn't use curly braces.
+      protected:
+        intrusive_ref() = default;
 
-        template <typename T>
-            requires std::is_arithmetic_v<T>
-        T
-        add(T const a, T const b)
+        // a copy is a new object with its own owners
+        intrusive_ref(intrusive_ref const &) noexcept
         {
-            return a + b;
         }
-    } // namespace requires_check
 
-    namespace requires_check_alternative
-    {
-        // the same, only different order (matter of personal taste)
+        intrusive_ref &
+        operator=(intrusive_ref const &) noexcept
+        {
+            return *this;
+        }
 
-        template <typename T>
-        T
-        add(T const a, T const b)
-            requires std::is_arithmetic_v<T>
+        ~intrusive_ref() = default;
+
+      private:
+        void
+        add_ref() const noexcept
         {
-            return a + b;
+            count.increment();
         }
-    } // namespace requires_check_alternative
 
-    namespace concept_check
-    {
-        // REQUIRES EXPRESSION uses curly braces.
-        // A requires expression is a Boolean expression that can be used with a requires clause.
+        void
+        release() const noexcept
+        {
+            static_assert(std::is_final_v<Derived> || std::has_virtual_destructor_v<Derived>,
+                          "a type derived from Derived would be deleted through the wrong static type");
+            if (count.decrement() == 0)
+            {
+                delete static_cast<Derived const *>(this);
+            }
+        }
+
+        mutable Policy count;
 
         template <typename T>
-        concept arithmetic = requires { std::is_arithmetic_v<T>; };
+        friend class intrusive_ptr;
+    };
 
-        template <arithmetic T> // used like a data type
-        T
-        add(T const a, T const b)
+    // shared ownership of an object derived from intrusive_ref
+    template <typename T>
+    class intrusive_ptr
+    {
+      public:
+        intrusive_ptr() noexcept = default;
+
+        // also safe for a raw pointer to an object that is already owned (the count is in the object)
+        explicit intrusive_ptr(T *p) noexcept : ptr(p)
         {
-            return a + b;
+            if (ptr)
+            {
+                ptr->add_ref();
+            }
         }
-    } // namespace concept_check
 
-    namespace concept_check_alternative
-    {
-        // simple requirement (doesn't use `requires` keyword)
-        template <typename T>
-        concept arithmetic = std::is_arithmetic_v<T>;
+        intrusive_ptr(intrusive_ptr const &other) noexcept : intrusive_ptr(other.ptr)
+        {
+        }
 
-        template <arithmetic T>
-        T
-        add(T const a, T const b)
+        intrusive_ptr(intrusive_ptr &&other) noexcept : ptr(std::exchange(other.ptr, nullptr))
         {
-            return a + b;
         }
-    } // namespace concept_check_alternative
 
-    namespace old_requirements_style
-    {
-        // old style
-        template <typename T, typename U = void>
-        struct is_container : std::false_type
+        intrusive_ptr &
+        operator=(intrusive_ptr other) noexcept
         {
-        };
+            std::swap(ptr, other.ptr);
+            return *this;
+        }
 
-        template <typename T>
-        struct is_container<T, std::void_t<typename T::value_type,               //
-                                           typename T::size_type,                //
-                                           typename T::allocator_type,           //
-                                           typename T::iterator,                 //
-                                           typename T::const_iterator,           //
-                                           decltype(std::declval<T>().size()),   //
-                                           decltype(std::declval<T>().begin()),  //
-                                           decltype(std::declval<T>().end()),    //
-                                           decltype(std::declval<T>().cbegin()), //
-                                           decltype(std::declval<T>().cend())>>  //
-            : std::true_type
+        ~intrusive_ptr()
         {
-        };
+            if (ptr)
+            {
+                ptr->release();
+            }
+        }
 
-        template <typename T, typename U = void>
-        constexpr bool is_container_v = is_container<T, U>::value;
-    } // namespace old_requirements_style
+        T *
+        get() const noexcept
+        {
+            return ptr;
+        }
 
-    namespace new_requirements_style
-    {
-        // NOTE: naming convention (`container` instead of `is_container` bc it's used like a data type)
-        template <typename T>
-        concept container = requires(T t) {
-            typename T::value_type;     // type requirement
-            typename T::size_type;      // ..
-            typename T::allocator_type; // ..
-            typename T::iterator;       // ..
-            typename T::const_iterator; // type requirement
-            t.size();                   // simple requirement
-            t.begin();                  // ..
-            t.end();                    // ..
-            t.cbegin();                 // ..
-            t.cend();                   // simple requirement
-        };
+        T &
+        operator*() const noexcept
+        {
+            return *ptr;
+        }
 
-        template <container C>
-        void
-        process(C &&)
+        T *
+        operator->() const noexcept
         {
-            // ...
+            return ptr;
         }
-    } // namespace new_requirements_style
-} // namespace constraints_concepts
 
-namespace simple_requirements
-{
-    // syntax: requires (parameter-list) { requirement-seq }
+        explicit
+        operator bool() const noexcept
+        {
+            return ptr != nullptr;
+        }
 
-    template <typename T>
-    concept arithmetic = requires { std::is_arithmetic_v<T>; };
+        friend bool
+        operator==(intrusive_ptr const &, intrusive_ptr const &) = default;
 
-    template <typename T>
-    concept arithmetic_alt = std::is_arithmetic_v<T>; // empty parameter list can be omitted
+      private:
+        T *ptr = nullptr;
+    };
 
-    template <typename T>
-    concept addable = requires(T a, T b) { a + b; };
+    template <typename T, typename... Args>
+    intrusive_ptr<T>
+    make_intrusive(Args &&...args)
+    {
+        return intrusive_ptr<T>{new T(std::forward<Args>(args)...)};
+    }
 
-    template <typename T>
-    concept logger = requires(T t) {
-        t.error("just"); // takes a single parameter of `const char*` or some type that can be constructed from it
-        t.warning("a");  // the actual values passed as arguments have no importance (they are never performed)
-        t.info("demo");  // they are only checked for type correctness
+    class building final : public intrusive_ref<building>
+    {
+        building() = default; // heap only: see make_intrusive
+
+        template <typename T, typename... Args>
+        friend intrusive_ptr<T> make_intrusive(Args &&...args);
     };
 
-    template <logger Logger>
-    void
-    log_error(Logger &l)
+    class local_building final : public intrusive_ref<local_building, plain_count> // single-threaded use only
     {
-        l.error("error");
-        l.warning("warning");
-        l.info("info");
+        local_building() = default;
+
+        template <typename T, typename... Args>
+        friend intrusive_ptr<T> make_intrusive(Args &&...args);
+    };
+
+    // copies every pointer of `from` `rounds` times (one increment and one decrement each)
+    template <typename Ptr>
+    double
+    copy_benchmark(std::vector<Ptr> const &from, int rounds)
+    {
+        return benchmarking::measure(
+            [&] {
+                for (int r = 0; r < rounds; ++r)
+                {
+                    std::vector<Ptr> copy(from);
+                    benchmarking::do_not_optimize(copy.data());
+                }
+            },
+            3);
     }
+} // namespace intrusive_ref_counting
 
-    struct console_logger
+namespace pooled_buildings
+{
+    // Size-class pool allocator for std::allocate_shared: blocks of 32, 64, 128 and 256 bytes are carved from
+    // 1 MiB slabs obtained with mmap (never from malloc). Each size class keeps a lock-free Treiber stack of free
+    // blocks; each thread keeps a small cache per class and only touches the shared stacks in batches.
+
+    constexpr std::size_t min_block   = 32;
+    constexpr std::size_t max_block   = 256;
+    constexpr std::size_t class_count = 4;
+    constexpr std::size_t slab_bytes  = 1 << 20;
+
+    constexpr std::size_t
+    size_class_of(std::size_t bytes)
+    {
+        return bytes <= min_block ? 0 : static_cast<std::size_t>(std::bit_width((bytes - 1) / min_block));
+    }
+
+    constexpr std::size_t
+    block_size(std::size_t size_class)
     {
+        return min_block << size_class;
+    }
+
+    // Free blocks of one size. A block is named by a 32-bit index (slab * blocks per slab + block in slab);
+    // the stack head packs a tag with the top index, so a CAS cannot succeed on a recycled head (ABA).
+    // Slabs are aligned to their size and block 0 of each slab holds the slab number, so a pointer maps back
+    // to its index without a lookup. Slabs are never unmapped.
+    class size_class
+    {
+      public:
+        explicit size_class(std::size_t block) : block(block), per_slab(slab_bytes / block)
+        {
+        }
+
+        // nullptr if there are no free blocks
+        void *
+        pop() noexcept
+        {
+            std::uint64_t head = top.load(std::memory_order_acquire);
+            while (static_cast<std::uint32_t>(head) != 0)
+            {
+                void               *p    = address(static_cast<std::uint32_t>(head));
+                std::uint32_t const next = std::atomic_ref{*static_cast<std::uint32_t *>(p)}.load(
+                    std::memory_order_relaxed); // may be stale if p was taken meanwhile: then the tag differs
+                if (top.compare_exchange_weak(head, tagged(head, next), std::memory_order_acquire,
+                                              std::memory_order_acquire))
+                {
+                    return p;
+                }
+            }
+            return nullptr;
+        }
+
+        // pop(), mapping more slabs while the stack is empty
+        void *
+        pop_or_grow()
+        {
+            void *p;
+            while (not (p = pop()))
+            {
+                grow();
+            }
+            return p;
+        }
+
         void
-        error(std::string_view msg)
+        push(void *p) noexcept
+        {
+            std::uint32_t const index = index_of(p);
+            std::uint64_t       head  = top.load(std::memory_order_relaxed);
+            do
+            {
+                std::atomic_ref{*static_cast<std::uint32_t *>(p)}.store(static_cast<std::uint32_t>(head),
+                                                                        std::memory_order_relaxed);
+            } while (not top.compare_exchange_weak(head, tagged(head, index), std::memory_order_release,
+                                                   std::memory_order_relaxed));
+        }
+
+        // maps one more slab and pushes all its blocks (as one chain, with one CAS)
+        void
+        grow()
+        {
+            std::lock_guard lock{growing};
+            if (static_cast<std::uint32_t>(top.load(std::memory_order_relaxed)) != 0)
+            {
+                return; // another thread grew the pool meanwhile
+            }
+
+            std::uint32_t const slab = slab_count.load(std::memory_order_relaxed);
+            if (slab == slabs.size())
+            {
+                throw std::bad_alloc{};
+            }
+
+            // map twice the size and trim, to align the slab to its size
+            void *mapped = ::mmap(nullptr, 2 * slab_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapped == MAP_FAILED)
+            {
+                throw std::bad_alloc{};
+            }
+            auto const start   = reinterpret_cast<std::uintptr_t>(mapped);
+            auto const aligned = (start + slab_bytes - 1) & ~(slab_bytes - 1);
+            if (aligned != start)
+            {
+                ::munmap(mapped, aligned - start);
+            }
+            ::munmap(reinterpret_cast<void *>(aligned + slab_bytes), start + slab_bytes - aligned);
+
+            auto *base = reinterpret_cast<std::byte *>(aligned);
+            std::memcpy(base, &slab, sizeof(slab));
+            slabs[slab].store(base, std::memory_order_release);
+            slab_count.store(slab + 1, std::memory_order_relaxed);
+
+            std::uint32_t const first = static_cast<std::uint32_t>(slab * per_slab) + 1;
+            std::uint32_t const last  = static_cast<std::uint32_t>(slab * per_slab + per_slab) - 1;
+            for (std::uint32_t i = first; i < last; ++i)
+            {
+                std::atomic_ref{*static_cast<std::uint32_t *>(address(i))}.store(i + 1, std::memory_order_relaxed);
+            }
+
+            std::uint64_t head = top.load(std::memory_order_relaxed);
+            do
+            {
+                std::atomic_ref{*static_cast<std::uint32_t *>(address(last))}.store(
+                    static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+            } while (not top.compare_exchange_weak(head, tagged(head, first), std::memory_order_release,
+                                                   std::memory_order_relaxed));
+        }
+
+        std::size_t
+        mapped_bytes() const
+        {
+            return slab_count.load(std::memory_order_relaxed) * slab_bytes;
+        }
+
+      private:
+        static std::uint64_t
+        tagged(std::uint64_t head, std::uint32_t index)
         {
-            std::cout << msg << std::endl;
+            return ((head >> 32) + 1) << 32 | index;
         }
 
-        void
-        warning(std::string_view msg)
+        void *
+        address(std::uint32_t index) const
         {
-            std::cout << msg << std::endl;
+            return slabs[index / per_slab].load(std::memory_order_acquire) + index % per_slab * block;
         }
 
-        void
-        info(std::string_view msg)
+        std::uint32_t
+        index_of(void *p) const
         {
-            std::cout << msg << std::endl;
+            auto const    at   = reinterpret_cast<std::uintptr_t>(p);
+            auto const    base = at & ~(slab_bytes - 1);
+            std::uint32_t slab = 0;
+            std::memcpy(&slab, reinterpret_cast<void *>(base), sizeof(slab));
+            return static_cast<std::uint32_t>(slab * per_slab + (at - base) / block);
         }
+
+        std::size_t const                         block;
+        std::size_t const                         per_slab;
+        std::atomic<std::uint64_t>                top{0}; // tag << 32 | index of the first free block (0 = none)
+        std::array<std::atomic<std::byte *>, 512> slabs{};
+        std::atomic<std::uint32_t>                slab_count{0};
+        std::mutex                                growing;
     };
-} // namespace simple_requirements
 
-namespace compound_requirement
-{
-    namespace
+    // never destroyed, like the slabs: blocks may be freed by static objects destroyed after any other static
+    inline std::array<size_class, class_count> &
+    size_classes()
     {
-        template <typename T>
-        void
-        f(T) noexcept // doesn't throw errors
+        static auto *classes = new std::array<size_class, class_count>{
+            size_class{block_size(0)}, size_class{block_size(1)}, size_class{block_size(2)}, size_class{block_size(3)}};
+        return *classes;
+    }
+
+    // per-thread free blocks, exchanged with the size classes `batch` at a time
+    class thread_cache
+    {
+      public:
+        thread_cache() = default;
+
+        thread_cache(thread_cache const &)            = delete;
+        thread_cache &operator=(thread_cache const &) = delete;
+
+        ~thread_cache()
         {
-            // ...
+            destroyed = true;
+            for (std::size_t c = 0; c < class_count; ++c)
+            {
+                while (sizes[c])
+                {
+                    size_classes()[c].push(blocks[c][--sizes[c]]);
+                }
+            }
         }
 
-        template <typename T>
-        void
-        g(T) // could throw errors
+        // nullptr once the thread's cache is gone: thread_locals destroyed after it may still free blocks
+        static thread_cache *
+        local()
         {
-            // ...
+            if (destroyed)
+            {
+                return nullptr;
+            }
+            thread_local thread_cache cache;
+            return &cache;
         }
-    } // namespace
 
-    namespace
-    {
-        // We want to check an expression for exceptions and/or return types.
-        // Syntax: { expression } [noexcept] [-> type_constraint];
-        // (both `noexcept` and `type_constraint` are optional)
-
-        template <typename F, typename... Args>
-        concept NonThrowing = requires(F &&func, Args... args) {
-            { func(args...) } noexcept; // checking for noexcept specifier
-        };
+        void *
+        allocate(std::size_t c)
+        {
+            if (sizes[c] == 0)
+            {
+                refill(c);
+            }
+            return blocks[c][--sizes[c]];
+        }
 
-        template <typename F, typename... Args>
-            requires NonThrowing<F, Args...>
         void
-        invoke(F &&func, Args... args)
+        deallocate(std::size_t c, void *p) noexcept
         {
-            func(args...);
+            if (sizes[c] == capacity)
+            {
+                for (std::size_t i = 0; i < batch; ++i)
+                {
+                    size_classes()[c].push(blocks[c][--sizes[c]]);
+                }
+            }
+            blocks[c][sizes[c]++] = p;
         }
-    } // namespace
-} // namespace compound_requirement
 
-namespace check_for_return_types
-{
-    // checking for return values (must be a type constraint; not the actual return type)
+      private:
+        static constexpr std::size_t capacity = 64;
+        static constexpr std::size_t batch    = 32;
 
-    template <typename T>
-    concept timer = requires(T t) {
-        { t.start() } -> std::same_as<void>;            // start() returns void
-        { t.stop() } -> std::convertible_to<long long>; // stop() returns anything convertible to long long
-    };
+        static inline thread_local bool destroyed = false; // trivially destructible, so readable until thread exit
 
-    struct timerA
-    {
         void
-        start()
+        refill(std::size_t c)
         {
-            // ...
+            size_class &shared = size_classes()[c];
+            while (sizes[c] < batch)
+            {
+                if (void *p = shared.pop())
+                {
+                    blocks[c][sizes[c]++] = p;
+                }
+                else if (sizes[c] == 0)
+                {
+                    shared.grow();
+                }
+                else
+                {
+                    break;
+                }
+            }
         }
 
-        int
-        // long long
-        stop()
-        {
-            return 0;
-        }
+        std::array<std::array<void *, capacity>, class_count> blocks;
+        std::array<std::size_t, class_count>                  sizes{};
     };
-} // namespace check_for_return_types
-
-namespace nested_requirements
-{
-    // std::conjunction_v performs a logical AND on the sequence of traits.
-    template <typename T, typename... Ts>
-    constexpr bool are_same_v = std::conjunction_v<std::is_same<T, Ts>...>;
 
-    template <typename... T>
-    concept HomogenousRange = requires(T... t) { // `requires`
-        (... + t);                               // simple requirement (no `requires`)
-        requires are_same_v<T...>;               // nested requirement: `requires` inside `requires`
-        requires sizeof...(T) > 1;               // nested requirement: `requires` inside `requires`
-    };
+    inline std::atomic<std::size_t> fallbacks{0}; // allocations too large for the pool
 
-    template <typename... T>
-        requires HomogenousRange<T...>
-    auto
-    add(T &&...t)
+    inline void *
+    allocate_bytes(std::size_t bytes, std::size_t alignment)
     {
-        return (... + t);
+        std::size_t const c = size_class_of(bytes);
+        if (bytes > max_block || alignment > block_size(c))
+        {
+            fallbacks.fetch_add(1, std::memory_order_relaxed);
+            return ::operator new(bytes, std::align_val_t{alignment});
+        }
+        if (thread_cache *cache = thread_cache::local())
+        {
+            return cache->allocate(c);
+        }
+        return size_classes()[c].pop_or_grow();
     }
-} // namespace nested_requirements
-
-namespace composing_constraints_1
-{
-    // Composing constraints
-
-    // with && (conjunction) and || (disjunction); short-circuited
 
-    template <typename T>
-        requires std::is_integral_v<T> && std::is_signed_v<T>
-    T
-    decrement(T value)
+    inline void
+    deallocate_bytes(void *p, std::size_t bytes, std::size_t alignment) noexcept
     {
-        return --value;
+        std::size_t const c = size_class_of(bytes);
+        if (bytes > max_block || alignment > block_size(c))
+        {
+            ::operator delete(p, bytes, std::align_val_t{alignment});
+            return;
+        }
+        // blocks may be freed by another thread than the allocating one
+        if (thread_cache *cache = thread_cache::local())
+        {
+            cache->deallocate(c, p);
+        }
+        else
+        {
+            size_classes()[c].push(p);
+        }
     }
-} // namespace composing_constraints_1
-
-namespace composing_constraints_2
-{
-    template <typename T>
-    concept Integral = std::is_integral_v<T>;
-
-    template <typename T>
-    concept Signed = std::is_signed_v<T>;
 
     template <typename T>
-    concept SignedIntegral = Integral<T> && Signed<T>;
-
-    template <SignedIntegral T>
-    T
-    decrement(T value)
-    {
-        return --value;
-    }
-} // namespace composing_constraints_2
-
-namespace constrain_template_parameter_packs
-{
-    // Conjunctions and disjunctions cannot be used to constrain template parameter packs.
-
-    template <typename... T>
-    //  requires std::is_integral_v<T> && ...  // error: this is not allowed
-        requires(std::is_integral_v<T> && ...) // now it's a fold expression of type-traits! (But: no short-circuiting!)
-    auto
-    add(T... args)
+    struct pool_allocator
     {
-        return (args + ...);
-    }
-} // namespace constrain_template_parameter_packs
+        using value_type = T;
 
-namespace concept_template_parameter_packs
-{
-    // we just give the thing a name (concept = named constraint)
-    template <typename T>
-    concept Integral = std::is_integral_v<T>; // RHS = boolean value
+        pool_allocator() = default;
 
-    // and now it works
-    template <typename... T>
-        requires(Integral<T> && ...) // fold with concepts creates a conjunction (WITH short-circuiting!)
-    auto
-    add(T... args)
-    {
-        return (args + ...);
-    }
-} // namespace concept_template_parameter_packs
+        template <typename U>
+        pool_allocator(pool_allocator<U> const &) noexcept // rebinding (allocate_shared allocates its own type)
+        {
+        }
 
-namespace anonymous_concepts_1
-{
-    template <typename T>
-    concept addable = requires(T a, T b) { a + b; }; // requires expression
+        T *
+        allocate(std::size_t n)
+        {
+            return static_cast<T *>(allocate_bytes(n * sizeof(T), alignof(T)));
+        }
 
-    template <typename T>
-        requires addable<T>                          // requires clause with concept
-    auto
-    add(T a, T b)
-    {
-        return a + b;
-    }
-} // namespace anonymous_concepts_1
+        void
+        deallocate(T *p, std::size_t n) noexcept
+        {
+            deallocate_bytes(p, n * sizeof(T), alignof(T));
+        }
 
-namespace anonymous_concepts_2
-{
-    // confusing syntax (requires requires ...); prefer n637a
+        bool
+        operator==(pool_allocator const &) const = default; // stateless: any pool_allocator frees any block
+    };
 
-    template <typename T>
-    //                "anonymous concept"
-    //           ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
-        requires requires(T a, T b) { a + b; } // requires clause with requires expression
-    auto
-    add(T a, T b)
+    // object and control block in one pool block
+    template <typename... Args>
+    std::shared_ptr<enable_shared_from_this_crtp::building>
+    make_building(Args &&...args)
     {
-        return a + b;
+        using enable_shared_from_this_crtp::building;
+        return std::allocate_shared<building>(pool_allocator<building>{}, std::forward<Args>(args)...);
     }
-} // namespace anonymous_concepts_2
-
-namespace abbreviated_function_template
-{
-    // In C++20 you can use the auto specifier in the function parameter list.
-    // This has the effect of transforming the function into a template function.
-    // Such a function using auto for function parameters is called an ABBREVIATED FUNCTION TEMPLATE.
 
-    // abbreviated function template
-    auto
-    add(auto a, auto b)
+    // buildings created and destroyed per second, in batches of 16 per thread
+    template <typename Make>
+    double
+    churn(unsigned threads, std::chrono::milliseconds duration, Make make)
     {
-        return a + b;
+        std::vector<std::size_t> created(threads);
+        std::atomic<bool>        done{false};
+        {
+            std::vector<std::jthread> workers;
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&, t] {
+                    std::array<std::shared_ptr<enable_shared_from_this_crtp::building>, 16> live;
+                    std::size_t                                                             n = 0;
+                    while (not done.load(std::memory_order_relaxed))
+                    {
+                        for (auto &b : live)
+                        {
+                            b = make();
+                        }
+                        n += live.size();
+                    }
+                    created[t] = n;
+                });
+            }
+            std::this_thread::sleep_for(duration);
+            done = true;
+        }
+        return static_cast<double>(std::accumulate(created.begin(), created.end(), std::size_t{0})) /
+               std::chrono::duration<double>(duration).count();
     }
-} // namespace abbreviated_function_template
+} // namespace pooled_buildings
 
-namespace constrained_abbreviated_function_template
+namespace rcu_buildings
 {
-    // constrained abbreviated function template (using concepts)
-    auto
-    add(std::integral auto a, std::integral auto b)
-    {
-        return a + b;
-    }
-} // namespace constrained_abbreviated_function_template
+    // Epoch-based RCU: readers announce the global epoch in their own cache line for the duration of a read,
+    // which is wait-free and touches no reference count. Writers swap in a new version, retire the old one with
+    // the next epoch, and free it once every reader has either left or announced that epoch or a later one.
 
-namespace constrained_abbreviated_variadic_function_template
-{
-    // constrained auto can also be used for variadic function templates
+    constexpr std::size_t max_readers = 128;
 
-    auto
-    add(std::integral auto... args)
+    // There is one domain per process: a thread's reader slot is a single thread_local, so a second domain would
+    // not see the epochs its readers announce and could free a version they still hold.
+    class rcu_domain
     {
-        return (args + ...);
-    }
-} // namespace constrained_abbreviated_variadic_function_template
-
-namespace constrained_auto_with_lambdas
-{
-    // constrained auto with generic lambdas (C++14)
-    auto sum = [](std::integral auto a, std::integral auto b) { return a + b; };
-
-    // constrained auto with templated lambdas (C++20)
-    auto twice = []<std::integral T>(T a) { return a + a; };
+      public:
+        static constexpr std::uint64_t idle = 0; // slot epoch outside of read sections
 
-} // namespace constrained_auto_with_lambdas
-
-namespace crtp
-{
-    // The Curiously Recurring Template Pattern
+        static rcu_domain &
+        global()
+        {
+            static rcu_domain domain;
+            return domain;
+        }
 
-    // general form:
-    // A: X<A>
+        rcu_domain(rcu_domain const &)            = delete;
+        rcu_domain &operator=(rcu_domain const &) = delete;
 
-    namespace
-    {
-        template <typename T>
-        struct Base
+        void
+        read_lock()
         {
-            void
-            f()
+            reader &r = local();
+            if (r.depth++ == 0)
             {
-                // this->do_f();                // error: No member named 'do_f' in 'Base<T>'
-
-                // calling function in derived class
-                static_cast<T *>(this)->do_f(); // upcast to 'Derived *'
+                // seq_cst: the announcement is ordered before the reader loads the protected pointer
+                r.slot->epoch.store(epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
             }
-        };
+        }
 
-        struct Derived : public Base<Derived>   // CRTP
+        void
+        read_unlock()
         {
-            void
-            do_f()
+            reader &r = local();
+            if (--r.depth == 0)
             {
-                std::println("Derived::f()");
+                r.slot->epoch.store(idle, std::memory_order_release);
             }
-        };
-    } // namespace
-
-    template <typename T>
-    void
-    process(Base<T> &b)
-    {
-        b.f();
-    }
-} // namespace crtp
+        }
 
-namespace limited_number
-{
-    namespace
-    {
-        // limiting number of instances of T to N
-        template <typename T, size_t N>
-        struct limited_instances
+        // called after unpublishing a version: versions retired with the returned epoch are freed once
+        // oldest_reader() >= it
+        std::uint64_t
+        advance()
         {
-            static std::atomic<size_t> count; // every instantiation has its own static count!
+            return epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        }
 
-            limited_instances()
+        // smallest epoch announced by a reader (max if there are no readers)
+        std::uint64_t
+        oldest_reader() const
+        {
+            std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+            for (reader_slot const &s : slots)
             {
-                if (count >= N)
+                std::uint64_t const e = s.epoch.load(std::memory_order_seq_cst);
+                if (e != idle)
                 {
-                    throw std::logic_error{"Too many instances"};
+                    oldest = std::min(oldest, e);
                 }
-                ++count;
             }
+            return oldest;
+        }
 
-            ~limited_instances()
+        // blocks until all read sections that started before the call have ended
+        void
+        synchronize()
+        {
+            std::uint64_t const e = advance();
+            while (oldest_reader() < e)
             {
-                --count;
+                std::this_thread::yield();
             }
-        };
+        }
 
-        // init of non-const static data member
-        template <typename T, size_t N>
-        std::atomic<size_t> limited_instances<T, N>::count = 0;
-    } // namespace
+      private:
+        rcu_domain() = default;
 
-    namespace
-    {
-        struct excalibur : limited_instances<excalibur, 1>
+        struct alignas(cache_line_size) reader_slot
         {
-            // ...
+            std::atomic<std::uint64_t> epoch{idle};
+            std::atomic<bool>          taken{false};
         };
 
-        struct book_of_magic : limited_instances<book_of_magic, 3>
+        // a thread's slot, claimed on its first read and given back when the thread exits
+        struct reader
         {
-            // ...
+            ~reader()
+            {
+                if (slot)
+                {
+                    slot->taken.store(false, std::memory_order_release);
+                }
+            }
+
+            reader_slot *slot  = nullptr;
+            unsigned     depth = 0; // nested read sections
         };
-    } // namespace
-} // namespace limited_number
 
-namespace composite_pattern
-{
-    // Actually we make hero and hero_party both iterables so we can treat them the same and
-    // derive them from a common base class.
-    //
-    // hero       = iterable of exactly one element
-    // hero_party = iterable of multiple elements/heros (implemented as a std::vector)
+        reader &
+        local()
+        {
+            thread_local reader r;
+            if (not r.slot)
+            {
+                for (reader_slot &s : slots)
+                {
+                    if (not s.taken.exchange(true, std::memory_order_acquire))
+                    {
+                        r.slot = &s;
+                        return r;
+                    }
+                }
+                throw std::length_error{"rcu_domain: more than max_readers reader threads"};
+            }
+            return r;
+        }
 
-    template <typename T>
-    struct base
-    {
-        template <typename U>
-        void ally_with(U &other);
+        std::atomic<std::uint64_t>           epoch{1};
+        std::array<reader_slot, max_readers> slots;
     };
 
-    struct hero : base<hero>
+    // A pointer to the current version of a T that is read far more often than it is replaced.
+    template <typename T>
+    class snapshot_ptr
     {
-        hero(std::string_view n) : name(n)
+      public:
+        // a read section: the version stays alive until the guard is destroyed
+        class read_guard
         {
-        }
+          public:
+            read_guard(read_guard const &)            = delete;
+            read_guard &operator=(read_guard const &) = delete;
 
-        // making hero into an iterable (for-range-loop capable)
-        hero *
-        begin()
+            ~read_guard()
+            {
+                domain.read_unlock();
+            }
+
+            T const *
+            get() const noexcept
+            {
+                return ptr;
+            }
+
+            T const &
+            operator*() const noexcept
+            {
+                return *ptr;
+            }
+
+            T const *
+            operator->() const noexcept
+            {
+                return ptr;
+            }
+
+          private:
+            read_guard(rcu_domain &d, std::atomic<T *> const &current) : domain(d)
+            {
+                domain.read_lock();
+                ptr = current.load(std::memory_order_seq_cst);
+            }
+
+            rcu_domain &domain;
+            T const    *ptr = nullptr;
+
+            friend class snapshot_ptr;
+        };
+
+        explicit snapshot_ptr(std::unique_ptr<T> initial) : current(initial.release())
         {
-            return this;
         }
 
-        hero *
-        end()
+        snapshot_ptr(snapshot_ptr const &)            = delete;
+        snapshot_ptr &operator=(snapshot_ptr const &) = delete;
+
+        ~snapshot_ptr()
         {
-            return this + 1; // there is only one hero in a hero ;-)
+            domain.synchronize();
+            delete current.load(std::memory_order_relaxed);
+            for (auto &[version, epoch] : retired)
+            {
+                delete version;
+            }
         }
 
-      private:
-        std::string      name;
-        std::set<hero *> connections;
+        read_guard
+        read() const
+        {
+            return read_guard{domain, current};
+        }
 
-        template <typename U>
-        friend struct base;
+        // replaces the current version; the old one is freed by a later reclaim()
+        void
+        publish(std::unique_ptr<T> next)
+        {
+            std::lock_guard lock{writer};
+            T *old = current.exchange(next.release(), std::memory_order_seq_cst);
+            retired.emplace_back(old, domain.advance());
+            reclaim_locked();
+        }
 
-        template <typename U>
-        friend std::ostream &operator<<(std::ostream &os, base<U> &object);
-    };
+        // frees the retired versions no reader can still see, returns how many
+        std::size_t
+        reclaim()
+        {
+            std::lock_guard lock{writer};
+            return reclaim_locked();
+        }
 
-    struct hero_party : std::vector<hero>, base<hero_party>
-    {
-    };
+        std::size_t
+        retired_count() const
+        {
+            std::lock_guard lock{writer};
+            return retired.size();
+        }
 
-    template <typename T>
-    template <typename U>
-    void
-    base<T>::ally_with(U &other)
-    {
-        for (hero &from : *static_cast<T *>(this)) // upcast base to hero or hero_party (this = base<T> *)
+      private:
+        std::size_t
+        reclaim_locked()
         {
-            for (hero &to : other)                 // make connections to hero or heros
-            {
-                from.connections.insert(&to);
-                to.connections.insert(&from);
-            }
+            std::uint64_t const oldest = domain.oldest_reader();
+            return std::erase_if(retired, [oldest](auto const &r) {
+                if (r.second > oldest)
+                {
+                    return false;
+                }
+                delete r.first;
+                return true;
+            });
         }
-    }
 
-    // print base (hero or hero_party)
-    template <typename T>
-    std::ostream &
-    operator<<(std::ostream &os, base<T> &object)
+        rcu_domain                                &domain = rcu_domain::global();
+        std::atomic<T *>                           current;
+        mutable std::mutex                         writer;
+        std::vector<std::pair<T *, std::uint64_t>> retired; // version, epoch it was retired with
+    };
+
+    // reads per second with `threads` readers while one writer publishes a new version every 100 us
+    template <typename Read, typename Publish>
+    double
+    read_scaling(unsigned threads, std::chrono::milliseconds duration, Read read, Publish publish)
     {
-        for (hero &obj : *static_cast<T *>(&object)) // upcast object to hero or hero_party (content is both hero(s))
+        std::vector<std::size_t> reads(threads);
+        std::atomic<bool>        done{false};
         {
-            for (hero *c : obj.connections)          // print hero's connections
+            std::vector<std::jthread> workers;
+            for (unsigned t = 0; t < threads; ++t)
             {
-                os << obj.name << " -> [" << c->name << "]" << '\n';
+                workers.emplace_back([&, t] {
+                    std::size_t n = 0;
+                    while (not done.load(std::memory_order_relaxed))
+                    {
+                        read();
+                        ++n;
+                    }
+                    reads[t] = n;
+                });
             }
+            workers.emplace_back([&] {
+                while (not done.load(std::memory_order_relaxed))
+                {
+                    publish();
+                    std::this_thread::sleep_for(std::chrono::microseconds{100});
+                }
+            });
+            std::this_thread::sleep_for(duration);
+            done = true;
         }
-        return os;
+        return static_cast<double>(std::accumulate(reads.begin(), reads.end(), std::size_t{0})) /
+               std::chrono::duration<double>(duration).count();
     }
-} // namespace composite_pattern
-
-namespace enable_shared_from_this_crtp
-{
-    // Helper type std::enabled_shared_from_this enables objects
-    // managed by a std::shared_ptr to generate more std::shared_ptr
-    // instances in a safe manner.
-
-    // The std::enable_shared_from_this class helps us create more shared_ptr
-    // objects from an existing one in a safe manner.
-    struct building : std::enable_shared_from_this<building>
-    {
-        // ...
-    };
-} // namespace enable_shared_from_this_crtp
+} // namespace rcu_buildings
 
 namespace typelists
 {
@@ -1421,17 +7210,197 @@ namespace typelists
     static_assert(std::is_same_v<at_t<2, typelist<int, char>>, empty_type>);
 } // namespace typelists
 
+namespace demo_runner
+{
+    // main() registers every demo as a named section; the command line picks which ones run:
+    //
+    //   cpp-beautiful-templates [--list] [--repeat N] [--time] [pattern ...]
+    //
+    // Patterns are section names or shell globs ('composite-pattern*'); without patterns every section runs.
+    // --time reports the time of every section (per run and fastest run). Output is buffered and flushed once
+    // at exit, so the timings do not include the terminal.
+
+    struct section
+    {
+        std::string_view name;
+        void (*run)();
+    };
+
+    struct options
+    {
+        std::vector<std::string_view> patterns;
+        std::size_t                   repeat = 1;
+        bool                          time   = false;
+        bool                          list   = false;
+    };
+
+    inline std::optional<options>
+    parse(int argc, char **argv)
+    {
+        options o;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view const arg = argv[i];
+            if (arg == "--time")
+            {
+                o.time = true;
+            }
+            else if (arg == "--list")
+            {
+                o.list = true;
+            }
+            else if (arg == "--repeat")
+            {
+                std::string_view const n = i + 1 < argc ? argv[++i] : "";
+                auto [end, error]        = std::from_chars(n.data(), n.data() + n.size(), o.repeat);
+                if (error != std::errc{} || end != n.data() + n.size() || o.repeat == 0)
+                {
+                    std::println(stderr, "--repeat needs a positive number");
+                    return std::nullopt;
+                }
+            }
+            else if (arg.starts_with("--"))
+            {
+                std::println(stderr, "unknown option {}", arg);
+                return std::nullopt;
+            }
+            else
+            {
+                o.patterns.push_back(arg);
+            }
+        }
+        return o;
+    }
+
+    template <check_for_return_types::timer Timer = benchmarking::stopwatch>
+    class registry
+    {
+      public:
+        void
+        add(std::string_view name, void (*run)())
+        {
+            sections.push_back({name, run});
+        }
+
+        // 0 if every selected section ran, 1 if one threw, 2 for a bad command line
+        int
+        run(int argc, char **argv)
+        {
+            static char buffer[1 << 20];
+            std::setvbuf(stdout, buffer, _IOFBF, sizeof(buffer)); // std::cout is synced with (and uses) stdout
+
+            std::optional<options> const o = parse(argc, argv);
+            if (not o)
+            {
+                return 2;
+            }
+
+            std::vector<section const *> selected;
+            for (section const &s : sections)
+            {
+                if (o->patterns.empty() || std::ranges::any_of(o->patterns, [&s](std::string_view p) {
+                        return matches(p, s.name);
+                    }))
+                {
+                    selected.push_back(&s);
+                }
+            }
+            for (std::string_view p : o->patterns)
+            {
+                if (std::ranges::none_of(sections, [p](section const &s) { return matches(p, s.name); }))
+                {
+                    std::println(stderr, "no section matches {}", p);
+                    return 2;
+                }
+            }
+
+            if (o->list)
+            {
+                for (section const *s : selected)
+                {
+                    std::println("{}", s->name);
+                }
+                std::fflush(stdout);
+                return 0;
+            }
+
+            struct timing
+            {
+                std::string_view name;
+                long long        total   = 0;
+                long long        fastest = std::numeric_limits<long long>::max();
+            };
+            std::vector<timing> timings;
+            int                 status = 0;
+
+            for (section const *s : selected)
+            {
+                timing t{s->name};
+                try
+                {
+                    for (std::size_t r = 0; r < o->repeat; ++r)
+                    {
+                        Timer timer;
+                        timer.start();
+                        s->run();
+                        long long const ns = timer.stop();
+                        t.total += ns;
+                        t.fastest = std::min(t.fastest, ns);
+                    }
+                    timings.push_back(t);
+                }
+                catch (std::exception const &e)
+                {
+                    std::fflush(stdout);
+                    std::println(stderr, "section {} failed: {}", s->name, e.what());
+                    status = 1;
+                }
+            }
+
+            if (o->time)
+            {
+                std::println("\n=== Section Timings ({} runs each) ===\n", o->repeat);
+                std::size_t width = 0;
+                for (timing const &t : timings)
+                {
+                    width = std::max(width, t.name.size());
+                }
+                for (timing const &t : timings)
+                {
+                    std::println("{}{} {:>10.3f} ms/run {:>10.3f} ms fastest", t.name,
+                                 std::string(width - t.name.size(), ' '),
+                                 static_cast<double>(t.total) / static_cast<double>(o->repeat) / 1e6,
+                                 static_cast<double>(t.fastest) / 1e6);
+                }
+            }
+            std::fflush(stdout);
+            return status;
+        }
+
+      private:
+        static bool
+        matches(std::string_view pattern, std::string_view name)
+        {
+            return ::fnmatch(std::string{pattern}.c_str(), std::string{name}.c_str(), 0) == 0;
+        }
+
+        std::vector<section> sections;
+    };
+} // namespace demo_runner
+
 int
-main()
+main(int argc, char **argv)
 {
     std::cout << std::boolalpha;
 
-    {
+    demo_runner::registry sections;
+
+    sections.add("deducing-tref-not-trefref", [] {
         // Forwarding references (T&&) are too easy. Everything works with them.
 
         using namespace deducing_Tref_not_Trefref;
 
-        std::cout << "\n=== Deducing T&, not T&&\n" << std::endl;
+        std::cout << "\n=== Deducing T&, not T&&\n" << '\n';
 
         int i = 42;
 
@@ -1452,12 +7421,12 @@ main()
 
         // pass volatile r-value ref
         // f(static_cast<volatile int &&>(i)); // ERROR
-    }
+    });
 
-    {
+    sections.add("r-values-are-kinda-like-const-lvalues", [] {
         using namespace rvalues_are_kinda_like_const_lvalues;
 
-        std::cout << "\n=== r-Values are kinda like const lvalues\n" << std::endl;
+        std::cout << "\n=== r-Values are kinda like const lvalues\n" << '\n';
 
         int i = 42;
 
@@ -1472,30 +7441,145 @@ main()
 
         // pass r-value ref
         // f(static_cast<int &&>(i));    // error
-    }
+    });
 
-    {
+    sections.add("function-templates-cant-be-partially-specialized-only-fully", [] {
         using namespace how_to_partially_specialize_a_function;
 
-        std::cout << "\n=== Function Templates can't be partially specialized - only fully!\n" << std::endl;
+        std::cout << "\n=== Function Templates can't be partially specialized - only fully!\n" << '\n';
 
         int i{};
-        std::cout << is_pointer(i) << std::endl;  // false
-        std::cout << is_pointer(&i) << std::endl; // true
-    }
+        std::cout << is_pointer(i) << '\n';  // false
+        std::cout << is_pointer(&i) << '\n'; // true
+    });
 
-    {
+    sections.add("good-tag-dispatch-btree-with-o-log-n-advance", [] {
+        using namespace good_tag_dispatch;
+
+        std::cout << "\n=== Good Tag Dispatch - B+Tree with O(log n) advance ===\n" << '\n';
+
+        tree<int> t;
+        for (int x : {42, 7, 19, 3, 7})
+        {
+            t.insert(x);
+        }
+        std::println("{} {}", t.size(), *advance(t.begin(), 2)); // 4 19 (3 7 19 42)
+
+        // advance(begin, n) on 10M elements: jump vs. the ++ loop vs. std::set
+        int const     n = 10'000'000;
+        tree<int>     big;
+        std::set<int> reference;
+        for (int x = 0; x < n; ++x)
+        {
+            big.insert(x);
+            reference.insert(reference.end(), x);
+        }
+
+        int const    half   = n / 2;
+        double const jump   = benchmarking::measure(
+            [&] { benchmarking::do_not_optimize(*advance(big.begin(), half)); }, 1000);
+        double const linear = benchmarking::measure(
+            [&] { benchmarking::do_not_optimize(*advance_impl(big.begin(), half, std::false_type{})); }, 3);
+        double const set    = benchmarking::measure(
+            [&] { benchmarking::do_not_optimize(*std::next(reference.begin(), half)); }, 3);
+        std::println("advance by {}: jump {:.0f} ns, ++ loop {:.2f} ms, std::set {:.2f} ms", half, jump, linear / 1e6,
+                     set / 1e6);
+    });
+
+    sections.add("good-tag-dispatch-small-vector", [] {
+        using namespace good_tag_dispatch;
+
+        std::cout << "\n=== Good Tag Dispatch - Small Vector ===\n" << '\n';
+
+        vector<int> v{1, 2, 3, 4, 5};
+        std::println("{} {}", *advance(v.begin(), 3), v.is_inline()); // 4 true (begin + 3, no allocation)
+        for (int i = 0; i < 16; ++i)
+        {
+            v.push_back(i);
+        }
+        std::println("{} {}", v.size(), v.is_inline()); // 21 false (spilled to the heap)
+
+        // many short-lived vectors of 12 elements
+        auto short_lived = [](auto make) {
+            return benchmarking::measure(
+                [&] {
+                    std::uint64_t sum = 0;
+                    for (int round = 0; round < 100'000; ++round)
+                    {
+                        auto w = make();
+                        for (int i = 0; i < 12; ++i)
+                        {
+                            w.push_back(i + round);
+                        }
+                        sum += std::accumulate(w.begin(), w.end(), std::uint64_t{0});
+                    }
+                    benchmarking::do_not_optimize(sum);
+                },
+                10);
+        };
+        double const standard = short_lived([] { return std::vector<int>{}; });
+        double const small    = short_lived([] { return small_vector<int, 16>{}; });
+        std::println("100'000 vectors: std::vector {:.2f} ms, small_vector {:.2f} ms", standard / 1e6, small / 1e6);
+    });
+
+    sections.add("good-tag-dispatch-contiguous-tier", [] {
+        using namespace good_tag_dispatch;
+
+        std::cout << "\n=== Good Tag Dispatch - Contiguous Tier ===\n" << '\n';
+
+        vector<int> v{3, 1, 2};
+        vector<int> w{0, 0, 0};
+        good_tag_dispatch::copy(v.begin(), v.end(), w.begin()); // contiguous_tag<int>: memmove
+        std::println("{} {}", good_tag_dispatch::equal(v.begin(), v.end(), w.begin()),
+                     std::is_same_v<algorithm_tag<tree<int>::iterator>, element_tag>); // true true
+
+        std::vector<double> zeros{0.0};
+        std::vector<double> negative_zeros{-0.0};
+        std::println("{}", good_tag_dispatch::equal(zeros.data(), zeros.data() + 1, negative_zeros.data())); // true
+
+        // the same data through all three tiers
+        std::size_t const          n = 4'000'000;
+        std::vector<int>           from(n, 1);
+        std::vector<int>           same(n, 1);
+        std::vector<int>           to(n);
+        std::vector<unsigned char> text1(4 * n, 'a');
+        std::vector<unsigned char> text2(4 * n, 'a');
+        text2.back() = 'b';
+
+        auto tiers = [](std::string_view name, auto contiguous, auto run) {
+            std::println("{:<24} element {:>6.2f} ms, random access {:>6.2f} ms, contiguous {:>6.2f} ms", name,
+                         benchmarking::measure([&] { run(element_tag{}); }, 10) / 1e6,
+                         benchmarking::measure([&] { run(random_access_tag{}); }, 10) / 1e6,
+                         benchmarking::measure([&] { run(contiguous); }, 10) / 1e6);
+        };
+        tiers("copy", contiguous_tag<int>{}, [&](auto tag) {
+            benchmarking::do_not_optimize(copy_impl(from.data(), from.data() + n, to.data(), tag));
+        });
+        tiers("fill", contiguous_tag<int>{}, [&](auto tag) {
+            fill_impl(to.data(), to.data() + n, 0, tag);
+            benchmarking::do_not_optimize(to.data());
+        });
+        tiers("equal", contiguous_tag<int>{}, [&](auto tag) {
+            benchmarking::do_not_optimize(equal_impl(from.data(), from.data() + n, same.data(), tag));
+        });
+        tiers("lexicographical_compare", contiguous_tag<unsigned char>{}, [&](auto tag) {
+            benchmarking::do_not_optimize(lexicographical_compare_impl(text1.data(), text1.data() + text1.size(),
+                                                                       text2.data(), text2.data() + text2.size(), tag));
+        });
+    });
+
+    sections.add("auto-templates", [] {
         using namespace template_auto;
 
-        std::cout << "\n=== auto Templates ===\n" << std::endl;
+        std::cout << "\n=== auto Templates ===\n" << '\n';
 
         // each parameter is deduced independently
         foo<42, 42.0, false, 'x'> myFoo;
         myFoo.f(); // [with auto ...x = {42, 4.2e+1, false, 'x'}]
-    }
+    });
 
-    {
-        std::cout << "\n=== Lambda Templates ===\n" << std::endl;
+    sections.add("lambda-templates", [] {
+        std::cout << "\n=== Lambda Templates ===\n" << '\n';
 
         auto l1 = [](int a) { return a + a; };           // regular lambda (C++11)
         auto l2 = [](auto a) { return a + a; };          // generic lambda (C++14)
@@ -1505,38 +7589,38 @@ main()
         int v2 = l2(21.0);
         int v3 = l3(21.0);
 
-        std::cout << v1 << std::endl; // 42
-        std::cout << v2 << std::endl; // 42
-        std::cout << v3 << std::endl; // 42
-    }
+        std::cout << v1 << '\n'; // 42
+        std::cout << v2 << '\n'; // 42
+        std::cout << v3 << '\n'; // 42
+    });
 
-    {
+    sections.add("variadic-function-templates", [] {
         using namespace variadic_function_templates;
 
-        std::cout << "\n=== Variadic Function Templates ===\n" << std::endl;
+        std::cout << "\n=== Variadic Function Templates ===\n" << '\n';
 
-        std::cout << min(7.5) << std::endl;            // 7.5
-        std::cout << min(42.0, 7.5) << std::endl;      // 7.5
-        std::cout << min(1, 5, 3, -4, 9) << std::endl; // -4
-    }
+        std::cout << min(7.5) << '\n';            // 7.5
+        std::cout << min(42.0, 7.5) << '\n';      // 7.5
+        std::cout << min(1, 5, 3, -4, 9) << '\n'; // -4
+    });
 
-    {
+    sections.add("sizeof-templates", [] {
         using namespace type_sizes;
 
-        std::cout << "\n=== sizeof() & Templates ===\n" << std::endl;
+        std::cout << "\n=== sizeof() & Templates ===\n" << '\n';
 
         auto sizes = get_type_sizes<short, int, long, long long>();
 
         for (auto const s : sizes)
         {
-            std::cout << s << std::endl; // 2 4 8 8
+            std::cout << s << '\n'; // 2 4 8 8
         }
-    }
+    });
 
-    {
+    sections.add("fold-expressions-summation", [] {
         using namespace summation;
 
-        std::cout << "\n=== Fold Expressions ===\n" << std::endl;
+        std::cout << "\n=== Fold Expressions ===\n" << '\n';
 
         // Four types of folds: (op is a binary operator)
         // unary  right fold (E op ...)      -> (E1 op (... op (EN-1 op EN)))
@@ -1546,27 +7630,27 @@ main()
 
         int n = sum(1, 2, 3, 4, 5);
 
-        std::cout << n << std::endl; // 15
-    }
+        std::cout << n << '\n'; // 15
+    });
 
-    {
+    sections.add("tuples", [] {
         using namespace tuple_template;
 
-        std::cout << "\n=== Tuples ===\n" << std::endl;
+        std::cout << "\n=== Tuples ===\n" << '\n';
 
         tuple one(42);
         tuple two(42, 42.5);
         tuple three(42, 42.5, 'a');
 
-        std::cout << get<0>(one) << std::endl;                                                   // 42
-        std::cout << get<0>(two) << " " << get<1>(two) << std::endl;                             // 42 42.5
-        std::cout << get<0>(three) << " " << get<1>(three) << " " << get<2>(three) << std::endl; // 42 42.5 a
-    }
+        std::cout << get<0>(one) << '\n';                                                   // 42
+        std::cout << get<0>(two) << " " << get<1>(two) << '\n';                             // 42 42.5
+        std::cout << get<0>(three) << " " << get<1>(three) << " " << get<2>(three) << '\n'; // 42 42.5 a
+    });
 
-    {
+    sections.add("fold-expressions-printing", [] {
         using namespace fold_expressions;
 
-        std::cout << "\n=== Fold Expressions ===\n" << std::endl;
+        std::cout << "\n=== Fold Expressions ===\n" << '\n';
 
         print1('d', 'o', 'g'); // dog
         print2('d', 'o', 'g'); // dog
@@ -1575,68 +7659,68 @@ main()
         push_back_many(v, 1, 2, 3, 4, 5);
 
         std::copy(v.begin(), v.end(), std::ostream_iterator<int>(std::cout, " ")); // 1 2 3 4 5
-    }
+    });
 
-    {
+    sections.add("factorial-class-template", [] {
         using namespace factorial_class_template;
 
-        std::cout << "\n\n=== Factorial Class Template ===\n" << std::endl;
+        std::cout << "\n\n=== Factorial Class Template ===\n" << '\n';
 
-        std::cout << factorial_v<0> << std::endl;  // 1
-        std::cout << factorial_v<1> << std::endl;  // 1
-        std::cout << factorial_v<2> << std::endl;  // 2
-        std::cout << factorial_v<3> << std::endl;  // 6
-        std::cout << factorial_v<4> << std::endl;  // 24
-        std::cout << factorial_v<5> << std::endl;  // 120
-        std::cout << factorial_v<12> << std::endl; // 479001600
-    }
+        std::cout << factorial_v<0> << '\n';  // 1
+        std::cout << factorial_v<1> << '\n';  // 1
+        std::cout << factorial_v<2> << '\n';  // 2
+        std::cout << factorial_v<3> << '\n';  // 6
+        std::cout << factorial_v<4> << '\n';  // 24
+        std::cout << factorial_v<5> << '\n';  // 120
+        std::cout << factorial_v<12> << '\n'; // 479001600
+    });
 
-    {
+    sections.add("factorial-variable-template", [] {
         using namespace factorial_variable_template;
 
-        std::cout << "\n=== Factorial Variable Template ===\n" << std::endl;
+        std::cout << "\n=== Factorial Variable Template ===\n" << '\n';
 
-        std::cout << factorial<0> << std::endl;  // 1
-        std::cout << factorial<1> << std::endl;  // 1
-        std::cout << factorial<2> << std::endl;  // 2
-        std::cout << factorial<3> << std::endl;  // 6
-        std::cout << factorial<4> << std::endl;  // 24
-        std::cout << factorial<5> << std::endl;  // 120
-        std::cout << factorial<12> << std::endl; // 479001600
-    }
+        std::cout << factorial<0> << '\n';  // 1
+        std::cout << factorial<1> << '\n';  // 1
+        std::cout << factorial<2> << '\n';  // 2
+        std::cout << factorial<3> << '\n';  // 6
+        std::cout << factorial<4> << '\n';  // 24
+        std::cout << factorial<5> << '\n';  // 120
+        std::cout << factorial<12> << '\n'; // 479001600
+    });
 
-    {
+    sections.add("factorial-function-template", [] {
         using namespace factorial_function_template;
 
-        std::cout << "\n=== Factorial Function Template ===\n" << std::endl;
+        std::cout << "\n=== Factorial Function Template ===\n" << '\n';
 
-        std::cout << factorial<0>() << std::endl;  // 1
-        std::cout << factorial<1>() << std::endl;  // 1
-        std::cout << factorial<2>() << std::endl;  // 2
-        std::cout << factorial<3>() << std::endl;  // 6
-        std::cout << factorial<4>() << std::endl;  // 24
-        std::cout << factorial<5>() << std::endl;  // 120
-        std::cout << factorial<12>() << std::endl; // 479001600
-    }
+        std::cout << factorial<0>() << '\n';  // 1
+        std::cout << factorial<1>() << '\n';  // 1
+        std::cout << factorial<2>() << '\n';  // 2
+        std::cout << factorial<3>() << '\n';  // 6
+        std::cout << factorial<4>() << '\n';  // 24
+        std::cout << factorial<5>() << '\n';  // 120
+        std::cout << factorial<12>() << '\n'; // 479001600
+    });
 
-    {
+    sections.add("factorial-constexpr", [] {
         using namespace factorial_constexpr;
 
-        std::cout << "\n=== Factorial Constexpr ===\n" << std::endl;
+        std::cout << "\n=== Factorial Constexpr ===\n" << '\n';
 
-        std::cout << factorial(0) << std::endl;  // 1
-        std::cout << factorial(1) << std::endl;  // 1
-        std::cout << factorial(2) << std::endl;  // 2
-        std::cout << factorial(3) << std::endl;  // 6
-        std::cout << factorial(4) << std::endl;  // 24
-        std::cout << factorial(5) << std::endl;  // 120
-        std::cout << factorial(12) << std::endl; // 479001600
-    }
+        std::cout << factorial(0) << '\n';  // 1
+        std::cout << factorial(1) << '\n';  // 1
+        std::cout << factorial(2) << '\n';  // 2
+        std::cout << factorial(3) << '\n';  // 6
+        std::cout << factorial(4) << '\n';  // 24
+        std::cout << factorial(5) << '\n';  // 120
+        std::cout << factorial(12) << '\n'; // 479001600
+    });
 
-    {
+    sections.add("enable-if", [] {
         using namespace enable_if_template;
 
-        std::cout << "\n=== enable_if ===\n" << std::endl;
+        std::cout << "\n=== enable_if ===\n" << '\n';
 
         // 'constexpr if' is a compile-time version of the if-statement.
         // The syntax for 'constexpr if' is 'if constexpr(condition)'.
@@ -1644,24 +7728,24 @@ main()
         widget w{1, "one"};
 
         serialize(std::cout, w); // 1,one
-    }
+    });
 
-    {
+    sections.add("sfinae", [] {
         using namespace sfinae_error;
 
-        std::cout << "\n=== SFINAE ===\n" << std::endl;
+        std::cout << "\n=== SFINAE ===\n" << '\n';
 
         int arr2[]{1, 2, 3, 4};
         handle(arr2); // handle even array: 4 elements
 
         int arr1[]{1, 2, 3, 4, 5};
         handle(arr1); // handle odd  array: 5 elements
-    }
+    });
 
-    {
+    sections.add("decltype", [] {
         using namespace decltype_templates;
 
-        std::cout << "\n=== decltype ===\n" << std::endl;
+        std::cout << "\n=== decltype ===\n" << '\n';
 
         foo<bool> b_foo;
         bar<bool> b_bar;
@@ -1671,12 +7755,12 @@ main()
 
         dummy<bool> b_dummy [[maybe_unused]];
         // handle(b_dummy); // error: doesn't have a foo_type or bar_type
-    }
+    });
 
-    {
+    sections.add("common-type", [] {
         using namespace common_type;
 
-        std::cout << "\n=== Common Type ===\n" << std::endl;
+        std::cout << "\n=== Common Type ===\n" << '\n';
 
         int a = 1;
         process(a);           // int
@@ -1685,57 +7769,57 @@ main()
         process(1, 2.0, '3'); // double
 
         // process(1, 2.0, "3"); // error
-    }
+    });
 
-    {
+    sections.add("parameter-checks", [] {
         using namespace constraints_concepts;
 
-        std::cout << "\n=== Parameter Checks ===\n" << std::endl;
+        std::cout << "\n=== Parameter Checks ===\n" << '\n';
 
-        std::cout << no_check::add(2, 4) << std::endl;                   // 6
-        std::cout << no_check::add("2"s, "4.0"s) << std::endl;           // 24.0 (Oops!)
-        std::cout << enable_if_check::add(2, 4) << std::endl;            // 6
-        std::cout << static_assert_check::add(2, 4) << std::endl;        // 6
-        std::cout << requires_check::add(2, 4) << std::endl;             // 6
-        std::cout << requires_check_alternative::add(2, 4) << std::endl; // 6
+        std::cout << no_check::add(2, 4) << '\n';                   // 6
+        std::cout << no_check::add("2"s, "4.0"s) << '\n';           // 24.0 (Oops!)
+        std::cout << enable_if_check::add(2, 4) << '\n';            // 6
+        std::cout << static_assert_check::add(2, 4) << '\n';        // 6
+        std::cout << requires_check::add(2, 4) << '\n';             // 6
+        std::cout << requires_check_alternative::add(2, 4) << '\n'; // 6
 
         static_assert(old_requirements_style::is_container_v<std::vector<int>>);
         static_assert(new_requirements_style::container<std::vector<int>>);
 
         new_requirements_style::process(std::vector{1, 2, 3}); // Ok
-    }
+    });
 
-    {
+    sections.add("simple-requirements", [] {
         using namespace simple_requirements;
 
-        std::cout << "\n=== Simple Requirements ===\n" << std::endl;
+        std::cout << "\n=== Simple Requirements ===\n" << '\n';
 
         console_logger cl;
         log_error(cl); // error | warning | info
-    }
+    });
 
-    {
+    sections.add("compound-requirements", [] {
         using namespace compound_requirement;
 
-        std::cout << "\n=== Compound Requirements ===\n" << std::endl;
+        std::cout << "\n=== Compound Requirements ===\n" << '\n';
 
         invoke(f<int>, 42);
 
         // invoke(g<int>, 42); // error
-    }
+    });
 
-    {
+    sections.add("check-return-types", [] {
         using namespace check_for_return_types;
 
-        std::cout << "\n=== Check Return Types ===\n" << std::endl;
+        std::cout << "\n=== Check Return Types ===\n" << '\n';
 
         static_assert(timer<timerA>);
-    }
+    });
 
-    {
+    sections.add("nested-requirements", [] {
         using namespace nested_requirements;
 
-        std::cout << "\n=== Nested Requirements ===\n" << std::endl;
+        std::cout << "\n=== Nested Requirements ===\n" << '\n';
 
         static_assert(HomogenousRange<int, int>);
         static_assert(HomogenousRange<int, int, int, int, int, int>);
@@ -1750,120 +7834,266 @@ main()
         // add(1);                         // error
         // add(1, 2.0);                    // error
         // add(1.0f, 2.0);                 // error
-    }
+    });
 
-    {
+    sections.add("simd-reduction-of-homogenous-ranges", [] {
+        using namespace simd_homogenous_range;
+
+        std::cout << "\n=== SIMD Reduction of Homogenous Ranges ===\n" << '\n';
+
+        std::println("{}", add(1, 2, 3, 4, 5, 6, 7, 8, 9));   // 45
+        std::println("{}", mul(1.0, 2.0, 3.0, 4.0));           // 24
+        std::println("{}", min(7, -3, 12, 5, 0));              // -3
+        std::println("{}", max(7.5f, -3.0f, 12.25f));          // 12.25
+        std::println("{}", dot(pack(1, 2, 3), pack(4, 5, 6))); // 32
+
+        // add(1, 2.0);                                        // error: not a HomogenousRange
+
+        benchmark_add<int, 4>(1'000'000);
+        benchmark_add<int, 8>(1'000'000);
+        benchmark_add<int, 16>(1'000'000);
+        benchmark_add<int, 32>(1'000'000);
+        benchmark_add<int, 64>(1'000'000);
+    });
+
+    sections.add("composing-constraints-1", [] {
         using namespace composing_constraints_1;
 
-        std::cout << "\n=== Composing Constraints 1 ===\n" << std::endl;
+        std::cout << "\n=== Composing Constraints 1 ===\n" << '\n';
 
         std::println("{}", decrement(5)); // 4
 
         // std::println("{}", decrement("foo")); // error
-    }
+    });
 
-    {
+    sections.add("composing-constraints-2", [] {
         using namespace composing_constraints_2;
 
-        std::cout << "\n=== Composing Constraints 2 ===\n" << std::endl;
+        std::cout << "\n=== Composing Constraints 2 ===\n" << '\n';
 
         std::println("{}", decrement(5)); // 4
 
         // std::println("{}", decrement("foo")); // error
-    }
+    });
 
-    {
+    sections.add("delta-zigzag-bit-packing-integer-codec", [] {
+        using namespace integer_codec;
+
+        std::cout << "\n=== Delta/Zigzag/Bit-Packing Integer Codec ===\n" << '\n';
+
+        std::println("{} {} {}", zigzag_encode(-3), zigzag_encode(3), zigzag_decode(5u)); // 5 6 -3
+
+        std::mt19937_64 rng{42};
+        std::size_t     n = 1'000'000;
+
+        // sorted: timestamps with small, irregular gaps
+        std::vector<std::int64_t>                   timestamps(n);
+        std::uniform_int_distribution<std::int64_t> gap{1, 1000};
+        std::int64_t                                t = 1'700'000'000'000;
+        for (auto &v : timestamps)
+        {
+            v = t += gap(rng);
+        }
+
+        // near-sorted: sequence numbers with local jitter
+        std::vector<std::int32_t>                   sequence(n);
+        std::uniform_int_distribution<std::int32_t> jitter{-50, 50};
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            sequence[i] = static_cast<std::int32_t>(i) * 4 + jitter(rng);
+        }
+
+        // signed: random walk around zero
+        std::vector<std::int32_t>  walk(n);
+        std::normal_distribution<> step{0.0, 100.0};
+        std::int32_t               w = 0;
+        for (auto &v : walk)
+        {
+            v = w += static_cast<std::int32_t>(step(rng));
+        }
+
+        report("timestamps", timestamps);
+        report("sequence", sequence);
+        report("random walk", walk);
+
+        // random block access
+        auto                                 c = column<std::int64_t>::encode(timestamps);
+        std::array<std::int64_t, block_size> block;
+        c.decode_block(1000, block);
+        std::println("{}", block[0] == timestamps[1000 * block_size]); // true
+
+        // column<double>::encode({}); // error: not an Integral
+    });
+
+    sections.add("constrain-template-parameter-packs", [] {
         using namespace constrain_template_parameter_packs;
 
-        std::cout << "\n=== Constrain Template Parameter Packs ===\n" << std::endl;
+        std::cout << "\n=== Constrain Template Parameter Packs ===\n" << '\n';
 
         std::println("{}", add(1, 2, 3));       // 6
         std::println("{}", add(1, 2, 3, 4, 5)); // 15
 
         // add(1, 42.0); // error
-    }
-    {
+    });
+    sections.add("constrain-template-parameter-packs-using-concepts", [] {
         using namespace concept_template_parameter_packs;
 
-        std::cout << "\n=== Constrain Template Parameter Packs Using Concepts ===\n" << std::endl;
+        std::cout << "\n=== Constrain Template Parameter Packs Using Concepts ===\n" << '\n';
 
         std::println("{}", add(1, 2, 3));       // 6
         std::println("{}", add(1, 2, 3, 4, 5)); // 15
 
         // add(1, 42.0); // error
-    }
+    });
 
-    {
+    sections.add("compile-time-unrolled-loops", [] {
+        using namespace static_loops;
+
+        std::cout << "\n=== Compile-Time Unrolled Loops ===\n" << '\n';
+
+        static_for<0, 10, 3>([](auto i) { std::cout << i << ' '; }); // 0 3 6 9
+        std::cout << '\n';
+
+        unroll<4>(6, [](std::size_t i) { std::cout << i << ' '; }); // 0 1 2 3 4 5
+        std::cout << '\n';
+
+        for_each_in_tuple(std::tuple{42, 4.2, "42"}, [](auto const &e) { std::cout << e << ' '; }); // 42 4.2 42
+        std::cout << '\n';
+
+        std::vector<double> a(1'000'003);
+        std::vector<double> b(a.size());
+        std::iota(a.begin(), a.end(), 0.0);
+        std::fill(b.begin(), b.end(), 0.5);
+        std::span<double const> x{a};
+        std::span<double const> y{b};
+
+        using benchmarking::do_not_optimize;
+
+        double loop       = benchmarking::measure([&] { do_not_optimize(dot_loop(x, y)); }, 10);
+        double unrolled   = benchmarking::measure([&] { do_not_optimize(dot_unroll<8>(x, y)); }, 10);
+        double static_acc = benchmarking::measure([&] { do_not_optimize(dot_static_for<8>(x, y)); }, 10);
+
+        double const expected = 250'001'250'001.5;
+        std::println("{} {} {}", dot_loop(x, y) == expected, dot_unroll<8>(x, y) == expected,
+                     dot_static_for<8>(x, y) == expected); // true true true
+        std::println("loop {:.2f} ms, unroll<8> {:.2f} ms, static_for<8> {:.2f} ms", loop / 1e6, unrolled / 1e6,
+                     static_acc / 1e6);
+    });
+
+    sections.add("anonymous-concepts-1", [] {
         using namespace anonymous_concepts_1;
 
-        std::cout << "\n=== Anonymous Concepts 1 ===\n" << std::endl;
+        std::cout << "\n=== Anonymous Concepts 1 ===\n" << '\n';
 
         std::println("{}", add(1, 2)); // 3
-    }
+    });
 
-    {
+    sections.add("anonymous-concepts-2", [] {
         using namespace anonymous_concepts_2;
 
-        std::cout << "\n=== Anonymous Concepts 2 ===\n" << std::endl;
+        std::cout << "\n=== Anonymous Concepts 2 ===\n" << '\n';
 
         std::println("{}", add(1, 2)); // 3
-    }
+    });
 
-    {
+    sections.add("abbreviated-function-template", [] {
         using namespace abbreviated_function_template;
 
-        std::cout << "\n=== Abbreviated Function Template ===\n" << std::endl;
+        std::cout << "\n=== Abbreviated Function Template ===\n" << '\n';
 
         // no constraints
         std::println("{}", add(4, 2));       // 6
         std::println("{}", add(4.0, 2));     // 6
         std::println("{}", add("4"s, "2"s)); // 42 (Oops!)
-    }
+    });
 
-    {
+    sections.add("constrained-abbreviated-function-template", [] {
         using namespace constrained_abbreviated_function_template;
 
-        std::cout << "\n=== Constrained Abbreviated Function Template ===\n" << std::endl;
+        std::cout << "\n=== Constrained Abbreviated Function Template ===\n" << '\n';
 
         std::println("{}", add(4, 2)); // 6
 
         // std::println("{}", add(4.2, 0));     // error
         // std::println("{}", add("4"s, "2"s)); // error
-    }
+    });
 
-    {
+    sections.add("constrained-abbreviated-variadic-function-template", [] {
         using namespace constrained_abbreviated_variadic_function_template;
 
-        std::cout << "\n=== Constrained Abbreviated Variadic Function Template ===\n" << std::endl;
+        std::cout << "\n=== Constrained Abbreviated Variadic Function Template ===\n" << '\n';
 
         std::println("{}", add(1, 2, 3)); // 6
 
         // add(1.0, 2.0, 3.0);                  // error
         // std::println("{}", add("4"s, "2"s)); // error
-    }
+    });
 
-    {
+    sections.add("constrained-auto-with-lambdas", [] {
         using namespace constrained_auto_with_lambdas;
 
-        std::cout << "\n=== Constrained Auto with Lambdas ===\n" << std::endl;
+        std::cout << "\n=== Constrained Auto with Lambdas ===\n" << '\n';
 
         std::println("{}", sum(1, 2)); // 3
         std::println("{}", twice(2));  // 4
-    }
+    });
 
-    {
+    sections.add("parallel-transform-with-constrained-lambdas", [] {
+        using namespace constrained_auto_with_lambdas;
+        using namespace parallel_transform_lambdas;
+
+        std::cout << "\n=== Parallel Transform with Constrained Lambdas ===\n" << '\n';
+
+        std::vector<int> in(8'000'000);
+        std::iota(in.begin(), in.end(), 0);
+        std::vector<int> out(in.size());
+
+        parallel_transform(in, out, twice); // warm up the pool
+
+        double serial   = benchmarking::measure([&] { std::transform(in.begin(), in.end(), out.begin(), twice); }, 5);
+        double parallel = benchmarking::measure([&] { parallel_transform(in, out, twice); }, 5);
+
+        std::println("{} {}", out[21], out.back()); // 42 15999998
+        std::println("serial {:.2f} ms, parallel {:.2f} ms", serial / 1e6, parallel / 1e6);
+
+        parallel_transform(in, out, [](std::integral auto x) { return sum(x, 1); });
+        std::println("{}", out[41]); // 42
+
+        std::vector<double> d [[maybe_unused]](10);
+        // parallel_transform(d, d, twice); // error: twice requires std::integral
+    });
+
+    sections.add("curiously-recurring-template-pattern-crtp", [] {
         using namespace crtp;
 
-        std::cout << "\n=== Curiously Recurring Template Pattern (CRTP) ===\n" << std::endl;
+        std::cout << "\n=== Curiously Recurring Template Pattern (CRTP) ===\n" << '\n';
 
         Derived d;
         process(d); // Derived::f()
-    }
+    });
 
-    {
+    sections.add("crtp-fused-pipeline-stages", [] {
+        using namespace crtp_pipeline;
+
+        std::cout << "\n=== CRTP - Fused Pipeline Stages ===\n" << '\n';
+
+        double total = 0;
+        auto   even  = filter([](record &r) { return r.key % 2 == 0; });
+        auto   times = map([](record &r) { r.value *= 10; });
+
+        auto p = counter{10} | even | times | sum_sink{total}; // one fused type, no virtual calls
+        p.run();
+        std::println("{}", total); // 200 (0 + 20 + 40 + 60 + 80)
+
+        benchmark<1>(4'000'000);
+        benchmark<4>(4'000'000);
+        benchmark<16>(4'000'000);
+    });
+
+    sections.add("crtp-limited-numbers", [] {
         using namespace limited_number;
 
-        std::cout << "\n=== CRTP - Limited Numbers ===\n" << std::endl;
+        std::cout << "\n=== CRTP - Limited Numbers ===\n" << '\n';
 
         // excalibur
 
@@ -1890,12 +8120,150 @@ main()
         {
             std::println("{}", e.what()); // Too many instances
         }
-    }
 
-    {
+        // contention: the limit holds with many threads
+
+        std::println("{}", max_live_instances<book_of_magic>(8, 10'000) == 3); // true: reached, never exceeded
+
+        for (unsigned threads : {1, 2, 4, 8, 16, 32, 64})
+        {
+            auto const r = contention<book_of_magic>(threads, 2'000);
+            std::println("{:2} threads: {:>7} admitted {:>7.1f} ns, {:>7} rejected {:>7.1f} ns", threads, r.admitted,
+                         r.admitted_ns, r.rejected, r.rejected_ns);
+        }
+
+        // pool mode: objects live in preallocated, cache-line aligned slots
+
+        auto sword = make<excalibur>();
+        std::println("{}", reinterpret_cast<std::uintptr_t>(sword.get()) % cache_line_size); // 0
+
+        try
+        {
+            auto another = make<excalibur>(); // no free slot
+        }
+        catch (std::exception &e)
+        {
+            std::println("{}", e.what()); // Too many instances
+        }
+
+        excalibur *old_address = sword.get();
+        sword.reset(); // releases the slot
+        auto reforged = make<excalibur>();
+        std::println("{}", reforged.get() == old_address); // true
+
+        // acquire policies: no exceptions when the limit is hit
+
+        using namespace std::chrono_literals;
+
+        {
+            auto first  = acquire<book_of_magic>();
+            auto second = acquire<book_of_magic>();
+            auto third  = acquire<book_of_magic>();
+
+            std::println("{}", try_acquire<book_of_magic>().has_value());    // false
+            std::println("{}", acquire_for<book_of_magic>(1ms).has_value()); // false
+
+            third.reset();
+            std::println("{}", try_acquire<book_of_magic>().has_value()); // true
+        }
+
+        {
+            book_of_magic on_stack; // direct instances take admissions from the same limit, not pool slots
+            auto          first  = try_acquire<book_of_magic>();
+            auto          second = try_acquire<book_of_magic>();
+
+            std::println("{}", try_acquire<book_of_magic>().has_value());    // false, a slot is still free
+            std::println("{}", acquire_for<book_of_magic>(1ms).has_value()); // false
+        }
+
+        policy_benchmark("throwing", 8, 50ms, [] {
+            try
+            {
+                auto book = make<book_of_magic>();
+                return size_t{1};
+            }
+            catch (std::logic_error const &)
+            {
+                return size_t{0};
+            }
+        });
+        policy_benchmark("try_acquire", 8, 50ms, [] { return size_t{try_acquire<book_of_magic>().has_value()}; });
+        policy_benchmark("acquire", 8, 50ms, [] {
+            auto book = acquire<book_of_magic>();
+            return size_t{1};
+        });
+        policy_benchmark("acquire_for", 8, 50ms, [] { return size_t{acquire_for<book_of_magic>(1ms).has_value()}; });
+
+        // metrics of all limited_instances instantiations
+
+        std::println("{:<50} {:>5} {:>7} {:>10} {:>13} {:>10}", "type", "limit", "current", "high-water",
+                     "constructions", "rejections");
+        for (auto const &m : snapshot())
+        {
+            std::println("{:<50} {:>5} {:>7} {:>10} {:>13} {:>10}", m.type, m.limit, m.current, m.high_water,
+                         m.constructions, m.rejections);
+        }
+    });
+
+    sections.add("composite-pattern-interned-hero-names", [] {
+        using namespace string_interning;
+
+        std::cout << "\n=== Composite Pattern - Interned Hero Names ===\n" << '\n';
+
+        symbol arthur = intern("Arthur");
+        std::println("{} {}", arthur == intern("Arthur"), arthur == intern("Lancelot")); // true false
+        std::println("{}", arthur.view());                                                // Arthur
+        std::println("{}", symbol_table::global().find("Nobody").has_value());             // false
+        std::println("{}", sizeof(symbol));                                               // 4
+
+        // 10M heroes sharing 100k distinct names
+        constexpr std::size_t heroes   = 10'000'000;
+        constexpr std::size_t distinct = 100'000;
+
+        std::mt19937                               rng{42};
+        std::uniform_int_distribution<std::size_t> pick{0, distinct - 1};
+        std::vector<std::string>                   names(distinct);
+        for (std::size_t i = 0; i < distinct; ++i)
+        {
+            names[i] = "Knight of the Round Table #" + std::to_string(i);
+        }
+
+        symbol_table       &table = symbol_table::global();
+        std::size_t const   known = table.size();
+        std::vector<symbol> symbols(heroes);
+        std::size_t         string_bytes = 0;
+        for (symbol &s : symbols)
+        {
+            std::string const &name = names[pick(rng)];
+            s                       = table.intern(name);
+            // a std::string per hero: the object plus, beyond the small string buffer, a heap block of at least
+            // capacity + 1 bytes with 8 bytes of malloc header, rounded to 16
+            string_bytes += sizeof(std::string) + (name.size() > 15 ? (name.size() + 1 + 8 + 15) / 16 * 16 : 0);
+        }
+        std::size_t const symbol_bytes = symbols.size() * sizeof(symbol) + table.memory_bytes();
+        std::println("{} heroes, {} names: std::string {} MiB, symbol {} MiB (table {} KiB)", heroes,
+                     table.size() - known, string_bytes >> 20, symbol_bytes >> 20, table.memory_bytes() >> 10);
+
+        // equality: one integer compare instead of a length check and memcmp on a separate heap block
+        std::vector<std::string> strings(1'000'000);
+        for (std::size_t i = 0; i < strings.size(); ++i)
+        {
+            strings[i] = std::string{table.view(symbols[i])};
+        }
+        std::string const &wanted_string = strings.front();
+        symbol const       wanted_symbol = symbols.front();
+        double const       by_string =
+            benchmarking::measure([&] { benchmarking::do_not_optimize(std::ranges::count(strings, wanted_string)); });
+        double const by_symbol = benchmarking::measure([&] {
+            benchmarking::do_not_optimize(std::ranges::count(std::span{symbols}.first(strings.size()), wanted_symbol));
+        });
+        std::println("count 1M names: std::string {:.2f} ms, symbol {:.2f} ms", by_string / 1e6, by_symbol / 1e6);
+    });
+
+    sections.add("composite-pattern", [] {
         using namespace composite_pattern;
 
-        std::cout << "\n=== Composite Pattern ===\n" << std::endl;
+        std::cout << "\n=== Composite Pattern ===\n" << '\n';
 
         // Implementing the composite design pattern
 
@@ -1931,12 +8299,390 @@ main()
 
         std::cout << party2; // Cador        -> [Bors]
                              // Constatine   -> [Bors]
-    }
+    });
 
-    {
+    sections.add("composite-pattern-csr-alliance-graph", [] {
+        using namespace composite_pattern;
+
+        std::cout << "\n=== Composite Pattern - CSR Alliance Graph ===\n" << '\n';
+
+        hero       arthur("Arthur");
+        hero       lancelot("Sir Lancelot");
+        hero_party party;
+        party.emplace_back("Bors");
+        party.emplace_back("Cador");
+
+        alliance_graph alliances;
+        alliances.ally(arthur, lancelot);
+        alliances.ally(arthur, party);
+        alliances.ally(lancelot, arthur); // duplicates are removed by compact()
+        alliances.ally(arthur, arthur);   // no self-loop
+        alliances.compact();
+
+        std::cout << alliances; // Arthur       -> [Sir Lancelot]
+                                // Arthur       -> [Bors]
+                                // Arthur       -> [Cador]
+                                // Sir Lancelot -> [Arthur]
+                                // Bors         -> [Arthur]
+                                // Cador        -> [Arthur]
+
+        // memory per edge and traversal: std::set<hero *> vs. CSR
+
+        hero_party left;
+        hero_party right;
+        for (int i = 0; i < 500; ++i)
+        {
+            left.emplace_back("Knight " + std::to_string(i));
+            right.emplace_back("Squire " + std::to_string(i));
+        }
+        left.ally_with(right); // 500 x 500 x 2 std::set insertions
+
+        alliance_graph big;
+        big.import(left);
+        big.import(right);
+        big.compact();
+
+        std::size_t const edges = big.csr().edge_count();
+        // libstdc++ set node: color (padded to a pointer) + 3 pointers + the hero * (allocator overhead not counted)
+        std::size_t const set_node = 4 * sizeof(void *) + sizeof(hero *);
+        std::println("{} edges, bytes per edge: std::set >= {}, csr {:.2f}", edges, set_node,
+                     static_cast<double>(big.csr().memory_bytes()) / static_cast<double>(edges));
+
+        std::uintptr_t sum   = 0;
+        auto           visit = [&sum](hero &, hero &to) { sum += reinterpret_cast<std::uintptr_t>(&to); };
+
+        double set_ns = benchmarking::measure([&] {
+            alliance_graph::for_each_set_edge(left, visit);
+            alliance_graph::for_each_set_edge(right, visit);
+        });
+        double csr_ns = benchmarking::measure([&] {
+            for (alliance_graph::vertex v = 0; v < big.csr().vertex_count(); ++v)
+            {
+                for (auto a : big.allies(v))
+                {
+                    sum += a;
+                }
+            }
+        });
+        benchmarking::do_not_optimize(sum);
+        std::println("traversal: std::set {:.2f} ms, csr {:.2f} ms", set_ns / 1e6, csr_ns / 1e6);
+    });
+
+    sections.add("composite-pattern-bulk-alliances", [] {
+        using namespace composite_pattern;
+
+        std::cout << "\n=== Composite Pattern - Bulk Alliances ===\n" << '\n';
+
+        hero       arthur("Arthur");
+        hero_party party;
+        party.emplace_back("Bors");
+        party.emplace_back("Cador");
+
+        arthur.ally_with_bulk(party); // heroes and parties mix as with ally_with
+        party.ally_with_bulk(arthur); // already allied: no duplicates
+
+        std::cout << arthur; // Arthur -> [Bors]
+                             // Arthur -> [Cador]
+
+        // ally_with vs. ally_with_bulk for two large parties (10'000 x 10'000 needs ~10 GB of std::set nodes)
+
+        auto make_parties = [](std::size_t n) {
+            std::pair<hero_party, hero_party> parties;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                parties.first.emplace_back("Knight " + std::to_string(i));
+                parties.second.emplace_back("Squire " + std::to_string(i));
+            }
+            return parties;
+        };
+
+        auto [knights1, squires1] = make_parties(700);
+        auto [knights2, squires2] = make_parties(700);
+
+        double nested = benchmarking::measure([&] { knights1.ally_with(squires1); });
+        double bulk   = benchmarking::measure([&] { knights2.ally_with_bulk(squires2); });
+
+        std::ostringstream out1;
+        std::ostringstream out2;
+        out1 << knights1 << squires1;
+        out2 << knights2 << squires2;
+        std::println("ally_with {:.2f} ms, ally_with_bulk {:.2f} ms, same alliances: {}", nested / 1e6, bulk / 1e6,
+                     out1.str() == out2.str());
+    });
+
+    sections.add("composite-pattern-handle-based-hero-arena", [] {
+        using namespace hero_arena;
+
+        std::cout << "\n=== Composite Pattern - Handle-Based Hero Arena ===\n" << '\n';
+
+        arena heroes;
+
+        handle arthur = heroes.create("Arthur");
+        party  knights(heroes);
+        knights.emplace_back("Bors");
+
+        heroes.ally(arthur, knights); // hero and party mix as with ally_with
+
+        for (int i = 0; i < 1000; ++i) // grow after the alliance: the arena reallocates, handles stay valid
+        {
+            knights.emplace_back("Knight " + std::to_string(i));
+        }
+        handle cador = knights.emplace_back("Cador");
+        heroes.ally(cador, arthur);
+
+        std::println("{}", heroes.name(heroes.allies(arthur).front())); // Bors
+        std::println("{}", heroes.allies(arthur).size());               // 2
+
+        heroes.destroy(cador);
+        handle reused = heroes.create("Gawain"); // takes Cador's slot with a new generation
+        std::println("{} {}", reused.index() == cador.index(), heroes.valid(cador)); // true false
+        std::println("{}", heroes.allies(arthur).size());                            // 1
+        std::println("{}", std::ranges::distance(knights));                          // 1001 (Cador is gone)
+
+        handle bors = *knights.begin();
+        heroes.destroy(bors);
+        handle percival = knights.emplace_back("Percival"); // reuses Bors' slot, which the party already covers
+        std::println("{} {}", percival.index() == bors.index(), std::ranges::distance(knights)); // true 1001
+
+        party  lovers(heroes);
+        handle tristan = lovers.emplace_back("Tristan");
+        lovers.emplace_back("Isolde");
+        heroes.ally(lovers, lovers);                       // no self-loops
+        std::println("{}", heroes.allies(tristan).size()); // 1
+        heroes.destroy(tristan);
+    });
+
+    sections.add("composite-pattern-alliance-graph-analytics", [] {
+        using namespace alliance_analytics;
+        using composite_pattern::alliance_graph;
+        using composite_pattern::hero;
+        using composite_pattern::hero_party;
+
+        std::cout << "\n=== Composite Pattern - Alliance Graph Analytics ===\n" << '\n';
+
+        hero       arthur("Arthur");
+        hero       lancelot("Sir Lancelot");
+        hero       mordred("Mordred");
+        hero       agravain("Agravain");
+        hero_party party;
+        party.emplace_back("Bors");
+        party.emplace_back("Cador");
+
+        alliance_graph alliances;
+        alliances.ally(arthur, party);
+        alliances.ally(party, lancelot);
+        alliances.ally(mordred, agravain); // a second component
+        alliances.compact();
+
+        for (vertex v : shortest_path(alliances.csr(), alliances.vertex_of(arthur), alliances.vertex_of(lancelot)))
+        {
+            std::print("{} ", alliances.name(v)); // Arthur Bors Sir Lancelot
+        }
+        std::println();
+        std::println("{}", k_hop(alliances.csr(), alliances.vertex_of(arthur), 1).size()); // 3
+        std::println("{}", shortest_path(alliances.csr(), alliances.vertex_of(arthur), alliances.vertex_of(mordred))
+                               .empty()); // true
+
+        std::vector<vertex> const labels = connected_components(alliances.csr());
+        std::println("{}", std::set<vertex>(labels.begin(), labels.end()).size()); // 2
+
+        // power-law graph: 2^18 vertices, ~4M directed edges
+        csr_graph const  g      = rmat(18, 8);
+        vertex const     source = std::ranges::max(std::views::iota(vertex{0}, static_cast<vertex>(g.vertex_count())),
+                                                   {}, [&g](vertex v) { return g.adjacent(v).size(); });
+        bfs_result const r      = bfs(g, source);
+
+        double const top_down = benchmarking::measure(
+            [&] { benchmarking::do_not_optimize(bfs(g, source, unreached, false).depth.data()); }, 5);
+        double const optimized =
+            benchmarking::measure([&] { benchmarking::do_not_optimize(bfs(g, source).depth.data()); }, 5);
+        double const components_1 = benchmarking::measure(
+            [&] { benchmarking::do_not_optimize(connected_components(g, 1).data()); }, 5);
+        double const components_n =
+            benchmarking::measure([&] { benchmarking::do_not_optimize(connected_components(g).data()); }, 5);
+
+        std::vector<vertex> const components = connected_components(g);
+        std::println("{} vertices, {} edges, {} reached, {} components", g.vertex_count(), g.edge_count(),
+                     std::ranges::count_if(r.depth, [](std::uint32_t d) { return d != unreached; }),
+                     std::set<vertex>(components.begin(), components.end()).size());
+        std::println("bfs: top-down {:.2f} ms, direction-optimizing {:.2f} ms", top_down / 1e6, optimized / 1e6);
+        std::println("components: 1 thread {:.2f} ms, {} threads {:.2f} ms", components_1 / 1e6,
+                     std::max(1u, std::thread::hardware_concurrency()), components_n / 1e6);
+    });
+
+    sections.add("composite-pattern-alliance-graph-snapshot", [] {
+        using namespace alliance_snapshot;
+        using composite_pattern::hero;
+        using composite_pattern::hero_party;
+
+        std::cout << "\n=== Composite Pattern - Alliance Graph Snapshot ===\n" << '\n';
+
+        std::filesystem::path const path = std::filesystem::temp_directory_path() / "alliances.snapshot";
+
+        hero       arthur("Arthur");
+        hero_party knights;
+        knights.emplace_back("Bors");
+        knights.emplace_back("Cador");
+
+        alliance_graph small;
+        small.ally(arthur, knights);
+        small.compact();
+        save(small, path);
+
+        snapshot loaded(path);
+        vertex   galahad = loaded.add_hero("Galahad"); // changes after loading go into the overlay
+        loaded.ally(galahad, 0);
+        loaded.ally(0, 1); // already in the snapshot
+        loaded.compact();
+        std::cout << loaded; // Arthur  -> [Bors]
+                             // Arthur  -> [Cador]
+                             // Arthur  -> [Galahad]
+                             // Bors    -> [Arthur]
+                             // Cador   -> [Arthur]
+                             // Galahad -> [Arthur]
+
+        // cold start: rebuilding with ally_with vs. mapping the snapshot (the file is in the page cache)
+        auto const start = std::chrono::steady_clock::now();
+        hero_party left;
+        hero_party right;
+        for (int i = 0; i < 1000; ++i)
+        {
+            left.emplace_back("Knight " + std::to_string(i));
+            right.emplace_back("Squire " + std::to_string(i));
+        }
+        left.ally_with(right);
+
+        alliance_graph big; // points into left and right
+        big.import(left);
+        big.import(right);
+        big.compact();
+        auto const built = std::chrono::steady_clock::now();
+        save(big, path);
+
+        auto const  load_start = std::chrono::steady_clock::now();
+        snapshot    mapped(path);
+        std::size_t touched    = 0;
+        for (vertex v = 0; v < mapped.hero_count(); ++v) // traverse everything once, in place
+        {
+            mapped.for_each_ally(v, [&touched](vertex a) { touched += a; });
+        }
+        auto const loaded_at = std::chrono::steady_clock::now();
+        benchmarking::do_not_optimize(touched);
+
+        using ms = std::chrono::duration<double, std::milli>;
+        std::println("{} heroes, {} edges, {} KiB: rebuild {:.2f} ms, mmap + traversal {:.2f} ms", mapped.hero_count(),
+                     mapped.edge_count(), std::filesystem::file_size(path) >> 10, ms(built - start).count(),
+                     ms(loaded_at - load_start).count());
+
+        std::ostringstream from_graph;
+        std::ostringstream from_snapshot;
+        from_graph << big;
+        from_snapshot << mapped;
+        std::println("same alliances: {}", from_graph.str() == from_snapshot.str()); // true
+
+        std::filesystem::remove(path);
+    });
+
+    sections.add("composite-pattern-buffered-alliance-export", [] {
+        using namespace alliance_export;
+        using composite_pattern::hero_party;
+
+        std::cout << "\n=== Composite Pattern - Buffered Alliance Export ===\n" << '\n';
+
+        hero_party left;
+        hero_party right;
+        for (int i = 0; i < 1000; ++i)
+        {
+            left.emplace_back("Knight " + std::to_string(i));
+            right.emplace_back("Squire " + std::to_string(i));
+        }
+        alliance_graph g;
+        g.ally(left, right);
+        g.compact();
+
+        std::filesystem::path const path    = std::filesystem::temp_directory_path() / "alliances.txt";
+        unsigned const              threads = std::max(1u, std::thread::hardware_concurrency());
+
+        auto to_file = [&path](auto &&dump) {
+            int const fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+            {
+                throw std::system_error{errno, std::generic_category(), "open " + path.string()};
+            }
+            dump(fd);
+            ::close(fd);
+        };
+
+        double const streamed = benchmarking::measure([&] {
+            std::ofstream out(path);
+            out << g; // one operator<< chain per edge
+        });
+        double const buffered = benchmarking::measure([&] { to_file([&g](int fd) { write_text(g, fd); }); });
+        double const parallel =
+            benchmarking::measure([&] { to_file([&g, threads](int fd) { write_text(g, fd, threads); }); });
+
+        std::ostringstream expected;
+        expected << g;
+        alliance_snapshot::mapped_file const written(path);
+        bool const same = expected.str() == std::string_view{written.bytes().data(), written.bytes().size()};
+
+        to_file([&g](int fd) { write_binary(g, fd); });
+        std::println("{} edges: operator<< {:.2f} ms, buffered {:.2f} ms, {} threads {:.2f} ms, same text: {}",
+                     g.csr().edge_count(), streamed / 1e6, buffered / 1e6, threads, parallel / 1e6, same);
+        std::println("binary edge list: {} KiB", std::filesystem::file_size(path) >> 10);
+
+        std::filesystem::remove(path);
+    });
+
+    sections.add("crtp-instrumentation-mixins", [] {
+        using namespace crtp_instrumentation;
+
+        std::cout << "\n=== CRTP - Instrumentation Mixins ===\n" << '\n';
+
+        counted_derived cd;
+        cd.f();                                            // Derived::f()
+        cd.f();                                            // Derived::f()
+        std::println("{}", counted_derived::call_count()); // 2
+
+        traced_derived td;
+        td.f(); // -> crtp_instrumentation::traced_derived
+                // Derived::f()
+                // <- crtp_instrumentation::traced_derived
+
+        // timing composite_pattern::base<hero_party>::ally_with()
+        using composite_pattern::hero;
+        using composite_pattern::hero_party;
+
+        struct timed_party : hero_party, timed<timed_party>
+        {
+        };
+
+        hero        arthur("Arthur");
+        timed_party party;
+        party.emplace_back("Bors");
+        party.invoke(&hero_party::ally_with<hero>, arthur);
+        std::println("{}", timed_party::call_count()); // 1
+        std::cout << party;                            // Bors -> [Arthur]
+    });
+
+    sections.add("static-vs-dynamic-polymorphism", [] {
+        using namespace polymorphism_benchmark;
+
+        std::cout << "\n=== Static vs. Dynamic Polymorphism ===\n" << '\n';
+
+        // per object: nanoseconds, branch misses, L1 instruction cache misses (n/a without perf access)
+        std::println("{:<8} {:<12} {:>12} {:>14} {:>14}", "mix", "strategy", "ns", "branch-misses", "icache-misses");
+
+        std::size_t const objects = 1'000'000; // up to 100'000'000 (needs ~10 GB)
+        benchmark(objects, 1);
+        benchmark(objects, 2);
+        benchmark(objects, type_count);
+    });
+
+    sections.add("enable-shared-from-this", [] {
         using namespace enable_shared_from_this_crtp;
 
-        std::cout << "\n=== Enable Shared from `this` ===" << std::endl;
+        std::cout << "\n=== Enable Shared from `this` ===" << '\n';
 
         building *b = new building();
 
@@ -1947,11 +8693,117 @@ main()
         // Member function shared_from_this creates more std::shared_ptr instances from an object,
         // which all refer to the same instance of the object
         std::shared_ptr<building> p2{b->shared_from_this()}; // OK
-    }
+    });
 
-    {
+    sections.add("enable-shared-from-this-intrusive-reference-counting", [] {
+        using namespace intrusive_ref_counting;
+
+        std::cout << "\n=== Enable Shared from `this` - Intrusive Reference Counting ===\n" << '\n';
+
+        intrusive_ptr<building> p1 = make_intrusive<building>();
+        building               *b  = p1.get();
+
+        intrusive_ptr<building> p2{b}; // OK: the count is in the object, unlike std::shared_ptr{b} twice
+        intrusive_ptr<building> p3 = b->from_this();
+        std::println("{} {}", b->use_count(), p2 == p3); // 3 true
+        std::println("{}", sizeof(p1));                   // 8 (std::shared_ptr: 16)
+
+        // copy-heavy workload: 100'000 owners copied 20 times
+        std::size_t const                                                   n = 100'000;
+        std::vector<std::shared_ptr<enable_shared_from_this_crtp::building>> shared;
+        std::vector<intrusive_ptr<building>>                                 intrusive;
+        std::vector<intrusive_ptr<local_building>>                           local;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            shared.push_back(std::make_shared<enable_shared_from_this_crtp::building>());
+            intrusive.push_back(make_intrusive<building>());
+            local.push_back(make_intrusive<local_building>());
+        }
+
+        std::println("copies:            shared_ptr {:.2f} ms, intrusive atomic {:.2f} ms, intrusive plain {:.2f} ms",
+                     copy_benchmark(shared, 20) / 1e6, copy_benchmark(intrusive, 20) / 1e6,
+                     copy_benchmark(local, 20) / 1e6);
+
+        // shared_from_this() locks a weak_ptr, from_this() increments
+        auto from_this_benchmark = [](auto const &owners, auto get) {
+            return benchmarking::measure(
+                [&] {
+                    for (auto const &owner : owners)
+                    {
+                        auto p = get(*owner);
+                        benchmarking::do_not_optimize(p.get());
+                    }
+                },
+                20);
+        };
+        std::println("(shared_)from_this: shared_ptr {:.2f} ms, intrusive atomic {:.2f} ms, intrusive plain {:.2f} ms",
+                     from_this_benchmark(shared, [](auto &o) { return o.shared_from_this(); }) / 1e6,
+                     from_this_benchmark(intrusive, [](auto &o) { return o.from_this(); }) / 1e6,
+                     from_this_benchmark(local, [](auto &o) { return o.from_this(); }) / 1e6);
+    });
+
+    sections.add("enable-shared-from-this-pool-allocated-buildings", [] {
+        using namespace pooled_buildings;
+        using namespace std::chrono_literals;
+
+        std::cout << "\n=== Enable Shared from `this` - Pool-Allocated Buildings ===\n" << '\n';
+
+        std::shared_ptr<enable_shared_from_this_crtp::building> b  = make_building();
+        std::shared_ptr<enable_shared_from_this_crtp::building> b2 = b->shared_from_this();
+        std::println("{} {}", b.use_count(), fallbacks.load()); // 2 0 (object and control block share one block)
+
+        for (unsigned threads : {1u, 2u, 4u, 8u})
+        {
+            double const shared = churn(threads, 100ms, [] {
+                return std::make_shared<enable_shared_from_this_crtp::building>();
+            });
+            double const pooled = churn(threads, 100ms, [] { return make_building(); });
+            std::println("{} threads: make_shared {:>6.1f} M/s, make_building {:>6.1f} M/s", threads, shared / 1e6,
+                         pooled / 1e6);
+        }
+        std::size_t mapped = 0;
+        for (size_class const &c : size_classes())
+        {
+            mapped += c.mapped_bytes();
+        }
+        std::println("pool slabs: {} KiB, fallbacks: {}", mapped >> 10, fallbacks.load()); // fallbacks: 0
+    });
+
+    sections.add("enable-shared-from-this-rcu-snapshots", [] {
+        using namespace rcu_buildings;
+        using namespace std::chrono_literals;
+        using enable_shared_from_this_crtp::building;
+
+        std::cout << "\n=== Enable Shared from `this` - RCU Snapshots ===\n" << '\n';
+
+        snapshot_ptr<building> town{std::make_unique<building>()};
+        {
+            auto seen = town.read(); // no reference count: the version lives until the read section ends
+            town.publish(std::make_unique<building>());
+            town.publish(std::make_unique<building>());
+            std::println("{} {}", town.read().get() != seen.get(), town.retired_count()); // true 2
+        }
+        std::println("{}", town.reclaim()); // 2 (the reader has left)
+
+        std::atomic<std::shared_ptr<building>> shared{std::make_shared<building>()};
+        for (unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u})
+        {
+            double const atomic_shared = read_scaling(
+                threads, 50ms, [&] { benchmarking::do_not_optimize(shared.load().get()); },
+                [&] { shared.store(std::make_shared<building>()); });
+            double const rcu = read_scaling(
+                threads, 50ms, [&] { benchmarking::do_not_optimize(town.read().get()); },
+                [&] { town.publish(std::make_unique<building>()); });
+            std::println("{:>2} readers: atomic<shared_ptr> {:>8.1f} M/s, snapshot_ptr {:>8.1f} M/s", threads,
+                         atomic_shared / 1e6, rcu / 1e6);
+        }
+    });
+
+    sections.add("typelists", [] {
         using namespace typelists;
 
-        std::cout << "\n=== Typelists ===\n" << std::endl;
-    }
+        std::cout << "\n=== Typelists ===\n" << '\n';
+    });
+
+    return sections.run(argc, argv);
 }